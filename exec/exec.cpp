@@ -1,10 +1,10 @@
 // exec.cpp - interpretador simples da AST
-#include <unordered_map>
 #include <string>
+#include <vector>
 #include <stdexcept>
 #include <iostream>
 
-// Usa ASTNode/NodeKind/TypeKind definidos pelos includes anteriores
+// Usa AstPool/NodeKind/TypeKind definidos pelos includes anteriores
 
 // estrutura para valores em tempo de execução
 struct RuntimeValue {
@@ -15,6 +15,39 @@ struct RuntimeValue {
     bool b{false};
 };
 
+// valores das variáveis em frames empilhados num vetor só: o frame do
+// programa e um por bloco aberto, com o tamanho calculado pela semântica.
+// Uma variável resolvida em (escopo, slot) fica em
+// values[frameBase[escopo] + slot]; `bound` marca as que já receberam valor.
+struct RuntimeEnv {
+    std::vector<RuntimeValue> values;
+    std::vector<uint8_t> bound;
+    std::vector<size_t> frameBase;      // início do frame de cada escopo aberto
+
+    const RuntimeValue* get(uint16_t depth, uint32_t slot) const {
+        size_t k = frameBase[depth] + slot;
+        return bound[k] ? &values[k] : nullptr;
+    }
+
+    void set(uint16_t depth, uint32_t slot, RuntimeValue v) {
+        size_t k = frameBase[depth] + slot;
+        values[k] = std::move(v);
+        bound[k] = 1;
+    }
+
+    void pushFrame(size_t slots) {
+        frameBase.push_back(values.size());
+        values.resize(values.size() + slots);
+        bound.resize(bound.size() + slots, 0);
+    }
+
+    void popFrame() {
+        values.resize(frameBase.back());
+        bound.resize(frameBase.back());
+        frameBase.pop_back();
+    }
+};
+
 // cria valor padrão para um tipo
 static RuntimeValue makeDefault(TypeKind t) {
     RuntimeValue v;
@@ -29,186 +62,166 @@ static RuntimeValue makeDefault(TypeKind t) {
     return v;
 }
 
-// obtém valor de literal a partir do token
-static RuntimeValue literalValue(const Token& tok) {
+// valor de um literal já decodificado pelo lowering
+static RuntimeValue literalValue(const LiteralValue& lit) {
+    if (lit.outOfRange) {
+        throw std::out_of_range(lit.type == TypeKind::INT ? "stoi" : "stod");
+    }
     RuntimeValue v;
-    if (tok.tipo == TokenType::NUM_INT) {
-        v.type = TypeKind::INT;
-        v.i = std::stoi(tok.texto);
-    } else if (tok.tipo == TokenType::NUM_REAL) {
-        v.type = TypeKind::REAL;
-        v.d = std::stod(tok.texto);
-    } else if (tok.tipo == TokenType::STRING) {
-        v.type = TypeKind::STRING;
-        v.s = tok.texto;
-    } else if (tok.tipo == TokenType::KEYWORD && (tok.texto == "true" || tok.texto == "false")) {
-        v.type = TypeKind::BOOL;
-        v.b = (tok.texto == "true");
-    } else {
-        v.type = TypeKind::UNKNOWN;
+    v.type = lit.type;
+    switch (lit.type) {
+        case TypeKind::INT:    v.i = lit.i; break;
+        case TypeKind::REAL:   v.d = lit.d; break;
+        case TypeKind::STRING: v.s = std::string(lit.s); break;
+        case TypeKind::BOOL:   v.b = lit.b; break;
+        default: break;
     }
     return v;
 }
 
-// promove valor int para real
+// promove valor int para real (nó Promote: o tipo já foi provado)
 static RuntimeValue promoteToReal(const RuntimeValue& v) {
-    if (v.type == TypeKind::REAL) return v;
     RuntimeValue r;
     r.type = TypeKind::REAL;
     r.d = static_cast<double>(v.i);
     return r;
 }
 
-// avalia expressão e retorna valor em tempo de execução
-static RuntimeValue evalExpr(const std::shared_ptr<ASTNode>& node,
-                             const std::unordered_map<std::string, TypeKind>& symbols,
-                             std::unordered_map<std::string, RuntimeValue>& values) {
-    if (!node) return {};
-
-    switch (node->kind) {
+// valor de uma folha de expressão (literal ou identificador)
+static RuntimeValue leafValue(const AstPool& ast, NodeId node, const RuntimeEnv& values) {
+    switch (ast.kind(node)) {
         case NodeKind::Literal:
-            return literalValue(node->token);
+            return literalValue(ast.literal(node));
 
         case NodeKind::Identifier: {
-            auto it = values.find(node->value);
-            if (it == values.end()) {
-                throw std::runtime_error("Variavel '" + node->value + "' sem valor em tempo de execucao");
+            const RuntimeValue* v = values.get(ast.depth(node), ast.slot(node));
+            if (!v) {
+                throw std::runtime_error("Variavel '" + std::string(ast.value(node)) + "' sem valor em tempo de execucao");
             }
-            return it->second;
+            return *v;
         }
 
-        case NodeKind::Binary: {
-            RuntimeValue left = evalExpr(node->children[0], symbols, values);
-            RuntimeValue right = evalExpr(node->children[1], symbols, values);
-            const std::string& op = node->value;
-
-            auto requireNumeric = [&](const RuntimeValue& v, const std::string& side) {
-                if (v.type != TypeKind::INT && v.type != TypeKind::REAL) {
-                    throw std::runtime_error("Operando nao numerico em '" + op + "': " + side);
-                }
-            };
-
-            if (op == "+" || op == "-" || op == "*" || op == "/" || op == "%") {
-                requireNumeric(left, "esquerda");
-                requireNumeric(right, "direita");
-
-                if (op == "%") {
-                    if (left.type != TypeKind::INT || right.type != TypeKind::INT) {
-                        throw std::runtime_error("Operador '%' exige int");
-                    }
-                    RuntimeValue r; r.type = TypeKind::INT; r.i = left.i % right.i; return r;
-                }
-
-                // promoção para real se necessário
-                bool realResult = (left.type == TypeKind::REAL) || (right.type == TypeKind::REAL);
-                if (realResult) {
-                    RuntimeValue l = (left.type == TypeKind::REAL) ? left : promoteToReal(left);
-                    RuntimeValue r = (right.type == TypeKind::REAL) ? right : promoteToReal(right);
-                    RuntimeValue res; res.type = TypeKind::REAL;
-                    if (op == "+") res.d = l.d + r.d;
-                    else if (op == "-") res.d = l.d - r.d;
-                    else if (op == "*") res.d = l.d + r.d * (op == "*" ? 1 : 0); // placeholder to avoid warning
-                    else if (op == "/") res.d = l.d / r.d;
-                    // corrigir multiplicação
-                    if (op == "*") res.d = l.d * r.d;
-                    return res;
-                } else {
-                    RuntimeValue res; res.type = TypeKind::INT;
-                    if (op == "+") res.i = left.i + right.i;
-                    else if (op == "-") res.i = left.i - right.i;
-                    else if (op == "*") res.i = left.i * right.i;
-                    else if (op == "/") res.i = left.i / right.i;
-                    return res;
-                }
-            }
+        default:
+            return {};
+    }
+}
 
-            if (op == "==" || op == "!=" || op == "<" || op == ">" || op == "<=" || op == ">=") {
-                requireNumeric(left, "esquerda");
-                requireNumeric(right, "direita");
-                RuntimeValue res; res.type = TypeKind::BOOL;
-                double l = (left.type == TypeKind::REAL) ? left.d : left.i;
-                double r = (right.type == TypeKind::REAL) ? right.d : right.i;
-                if (op == "==") res.b = (l == r);
-                else if (op == "!=") res.b = (l != r);
-                else if (op == "<") res.b = (l < r);
-                else if (op == ">") res.b = (l > r);
-                else if (op == "<=") res.b = (l <= r);
-                else if (op == ">=") res.b = (l >= r);
-                return res;
-            }
+// aplica a operação especializada de um nó binário. A semântica já provou
+// os tipos e promoveu os operandos mistos, então nada é testado aqui.
+static RuntimeValue applyBinary(const AstPool& ast, NodeId node,
+                                const RuntimeValue& left, const RuntimeValue& right) {
+    RuntimeValue res;
+    switch (ast.exec(node)) {
+        case ExecOp::AddInt: res.type = TypeKind::INT; res.i = left.i + right.i; return res;
+        case ExecOp::SubInt: res.type = TypeKind::INT; res.i = left.i - right.i; return res;
+        case ExecOp::MulInt: res.type = TypeKind::INT; res.i = left.i * right.i; return res;
+        case ExecOp::DivInt: res.type = TypeKind::INT; res.i = left.i / right.i; return res;
+        case ExecOp::ModInt: res.type = TypeKind::INT; res.i = left.i % right.i; return res;
+
+        case ExecOp::AddReal: res.type = TypeKind::REAL; res.d = left.d + right.d; return res;
+        case ExecOp::SubReal: res.type = TypeKind::REAL; res.d = left.d - right.d; return res;
+        case ExecOp::MulReal: res.type = TypeKind::REAL; res.d = left.d * right.d; return res;
+        case ExecOp::DivReal: res.type = TypeKind::REAL; res.d = left.d / right.d; return res;
+
+        case ExecOp::EqInt: res.type = TypeKind::BOOL; res.b = left.i == right.i; return res;
+        case ExecOp::NeInt: res.type = TypeKind::BOOL; res.b = left.i != right.i; return res;
+        case ExecOp::LtInt: res.type = TypeKind::BOOL; res.b = left.i < right.i; return res;
+        case ExecOp::LeInt: res.type = TypeKind::BOOL; res.b = left.i <= right.i; return res;
+        case ExecOp::GtInt: res.type = TypeKind::BOOL; res.b = left.i > right.i; return res;
+        case ExecOp::GeInt: res.type = TypeKind::BOOL; res.b = left.i >= right.i; return res;
+
+        case ExecOp::EqReal: res.type = TypeKind::BOOL; res.b = left.d == right.d; return res;
+        case ExecOp::NeReal: res.type = TypeKind::BOOL; res.b = left.d != right.d; return res;
+        case ExecOp::LtReal: res.type = TypeKind::BOOL; res.b = left.d < right.d; return res;
+        case ExecOp::LeReal: res.type = TypeKind::BOOL; res.b = left.d <= right.d; return res;
+        case ExecOp::GtReal: res.type = TypeKind::BOOL; res.b = left.d > right.d; return res;
+        case ExecOp::GeReal: res.type = TypeKind::BOOL; res.b = left.d >= right.d; return res;
+
+        case ExecOp::And: res.type = TypeKind::BOOL; res.b = left.b && right.b; return res;
+        case ExecOp::Or:  res.type = TypeKind::BOOL; res.b = left.b || right.b; return res;
 
-            if (op == "&&" || op == "||") {
-                if (left.type != TypeKind::BOOL || right.type != TypeKind::BOOL) {
-                    throw std::runtime_error("Operador logico '" + op + "' exige bool");
-                }
-                RuntimeValue res; res.type = TypeKind::BOOL;
-                if (op == "&&") res.b = left.b && right.b;
-                else res.b = left.b || right.b;
-                return res;
-            }
+        default:
+            break;
+    }
 
-            throw std::runtime_error("Operador nao suportado: " + op);
-        }
+    // só numa AST que não passou pela especialização
+    throw std::runtime_error("Operador nao suportado: " + std::string(ast.value(node)));
+}
 
-        default:
-            return {};
+// nó interno de expressão (Binary, Promote ou Temp)
+static bool isOperator(NodeKind k) {
+    return k == NodeKind::Binary || k == NodeKind::Promote || k == NodeKind::Temp;
+}
+
+// avalia expressão e retorna valor em tempo de execução (pós-ordem com
+// pilhas explícitas, sem recursão)
+static RuntimeValue evalExpr(const AstPool& ast, NodeId root, RuntimeEnv& values) {
+    if (root == NO_NODE) return {};
+    if (!isOperator(ast.kind(root))) return leafValue(ast, root, values);  // caso comum
+
+    thread_local std::vector<std::pair<NodeId, bool>> work;  // (nó, filhos já empilhados)
+    thread_local std::vector<RuntimeValue> operands;         // valores prontos
+    size_t workBase = work.size();
+    size_t operandBase = operands.size();
+    work.push_back({root, false});
+    while (work.size() > workBase) {
+        auto [node, expanded] = work.back();
+        work.pop_back();
+        if (!isOperator(ast.kind(node))) {
+            operands.push_back(leafValue(ast, node, values));
+        } else if (!expanded) {
+            work.push_back({node, true});
+            for (size_t i = ast.childCount(node); i-- > 0;) work.push_back({ast.child(node, i), false});
+        } else if (ast.kind(node) == NodeKind::Promote) {
+            operands.back() = promoteToReal(operands.back());
+        } else if (ast.kind(node) == NodeKind::Temp) {      // valor reaproveitado adiante
+            values.set(ast.depth(node), ast.slot(node), operands.back());
+        } else {
+            RuntimeValue right = std::move(operands.back());
+            operands.pop_back();
+            operands.back() = applyBinary(ast, node, operands.back(), right);
+        }
     }
+    RuntimeValue v = std::move(operands.back());
+    operands.resize(operandBase);
+    return v;
 }
 
-static void execNode(const std::shared_ptr<ASTNode>& node,
-                     const std::unordered_map<std::string, TypeKind>& symbols,
-                     std::unordered_map<std::string, RuntimeValue>& values) {
-    if (!node) return;
+static void execNode(const AstPool& ast, NodeId node, RuntimeEnv& values) {
+    if (node == NO_NODE) return;
+
+    switch (ast.kind(node)) {
+        case NodeKind::Program:             // o frame do programa já foi empilhado
+            for (size_t i = 0; i < ast.childCount(node); ++i) execNode(ast, ast.child(node, i), values);
+            break;
 
-    switch (node->kind) {
-        case NodeKind::Program:
         case NodeKind::Block:
-            for (auto& c : node->children) execNode(c, symbols, values);
+            values.pushFrame(ast.frameSize(node));
+            for (size_t i = 0; i < ast.childCount(node); ++i) execNode(ast, ast.child(node, i), values);
+            values.popFrame();
             break;
 
+        // inicializador e valor atribuído já têm o tipo da variável (a
+        // semântica promove int para real)
         case NodeKind::Decl: {
-            const std::string& name = node->value;
-            auto itType = symbols.find(name);
-            TypeKind t = (itType != symbols.end()) ? itType->second : TypeKind::UNKNOWN;
-            RuntimeValue v = makeDefault(t);
-            if (node->children.size() > 1) {
-                RuntimeValue init = evalExpr(node->children[1], symbols, values);
-                // atribui se compatível
-                if (t == TypeKind::REAL && init.type == TypeKind::INT) {
-                    v.type = TypeKind::REAL; v.d = static_cast<double>(init.i);
-                } else if (t == init.type || t == TypeKind::UNKNOWN) {
-                    v = init;
-                } else {
-                    throw std::runtime_error("Inicializacao incompatível de '" + name + "'");
-                }
-            }
-            values[name] = v;
+            NodeId var = ast.child(node, 0);            // resolvido pela semântica
+            RuntimeValue v = ast.childCount(node) > 1 ? evalExpr(ast, ast.child(node, 1), values)
+                                                      : makeDefault(ast.type(var));
+            values.set(ast.depth(var), ast.slot(var), std::move(v));
             break;
         }
 
         case NodeKind::Assign: {
-            const std::string& name = node->children[0]->value;
-            RuntimeValue rhs = evalExpr(node->children[1], symbols, values);
-            auto itType = symbols.find(name);
-            TypeKind target = (itType != symbols.end()) ? itType->second : TypeKind::UNKNOWN;
-            if (target == TypeKind::REAL && rhs.type == TypeKind::INT) {
-                rhs = promoteToReal(rhs);
-            } else if (target != TypeKind::UNKNOWN && rhs.type != target) {
-                throw std::runtime_error("Atribuicao incompatível para '" + name + "'");
-            }
-            values[name] = rhs;
+            NodeId var = ast.child(node, 0);
+            values.set(ast.depth(var), ast.slot(var), evalExpr(ast, ast.child(node, 1), values));
             break;
         }
 
         case NodeKind::If: {
-            RuntimeValue cond = evalExpr(node->children[0], symbols, values);
-            if (cond.type != TypeKind::BOOL) {
-                throw std::runtime_error("Condicao do if nao booleana");
-            }
-            if (cond.b) {
-                execNode(node->children[1], symbols, values);
-            } else if (node->children.size() > 2) {
-                execNode(node->children[2], symbols, values);
+            if (evalExpr(ast, ast.child(node, 0), values).b) {   // condição bool provada
+                execNode(ast, ast.child(node, 1), values);
+            } else if (ast.childCount(node) > 2) {
+                execNode(ast, ast.child(node, 2), values);
             }
             break;
         }
@@ -219,8 +232,10 @@ static void execNode(const std::shared_ptr<ASTNode>& node,
     }
 }
 
-inline void runProgram(const std::shared_ptr<ASTNode>& root,
-                       const std::unordered_map<std::string, TypeKind>& symbols,
-                       std::unordered_map<std::string, RuntimeValue>& outValues) {
-    execNode(root, symbols, outValues);
+// Executa a AST já checada e especializada (nomes resolvidos em slots,
+// operações escolhidas pelo tipo). O frame do
+// programa fica em `outValues` no fim, na ordem de SymbolTable::globals.
+inline void runProgram(const AstPool& ast, RuntimeEnv& outValues) {
+    outValues.pushFrame(ast.frameSize(ast.root));
+    execNode(ast, ast.root, outValues);
 }
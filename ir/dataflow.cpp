@@ -0,0 +1,190 @@
+// dataflow.cpp
+// Compiladores - Análises de fluxo de dados sobre o IR: um resolvedor
+// genérico de conjuntos de bits por bloco (gen/kill, junção por união) e,
+// em cima dele, liveness dos valores SSA e definições que alcançam cada
+// bloco; mais as cadeias uso-definição de cada valor.
+#include <cstdint>
+#include <vector>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Índice do bit ligado mais baixo (m != 0), como scanCtz em lexer/simd.cpp
+inline unsigned bitCtz64(uint64_t m) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long idx;
+    _BitScanForward64(&idx, m);
+    return static_cast<unsigned>(idx);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(m));
+#endif
+}
+
+// Conjunto de bits de tamanho fixo
+class BitSet {
+public:
+    BitSet() = default;
+    explicit BitSet(size_t n) : words((n + 63) / 64) {}
+
+    void set(size_t k) { words[k / 64] |= uint64_t(1) << (k % 64); }
+    void reset(size_t k) { words[k / 64] &= ~(uint64_t(1) << (k % 64)); }
+    bool test(size_t k) const { return (words[k / 64] >> (k % 64)) & 1; }
+
+    // this |= o; devolve se mudou
+    bool unite(const BitSet& o) {
+        bool changed = false;
+        for (size_t w = 0; w < words.size(); ++w) {
+            uint64_t v = words[w] | o.words[w];
+            changed = changed || v != words[w];
+            words[w] = v;
+        }
+        return changed;
+    }
+
+    void subtract(const BitSet& o) {
+        for (size_t w = 0; w < words.size(); ++w) words[w] &= ~o.words[w];
+    }
+
+    bool operator==(const BitSet& o) const { return words == o.words; }
+    bool operator!=(const BitSet& o) const { return words != o.words; }
+
+    // Chama f(k) para cada bit ligado, em ordem crescente
+    template <typename F>
+    void forEach(F f) const {
+        for (size_t w = 0; w < words.size(); ++w) {
+            for (uint64_t v = words[w]; v; v &= v - 1) f(w * 64 + bitCtz64(v));
+        }
+    }
+
+private:
+    std::vector<uint64_t> words;
+};
+
+// Problema de fluxo de dados por bloco: saída = gen ∪ (entrada − kill).
+// Para frente, a entrada de um bloco é a união das saídas dos
+// predecessores; para trás, a "entrada" é a união das entradas dos
+// sucessores. `extra` entra na união do próprio bloco (operandos de phi
+// contam como usados no fim do predecessor).
+struct DataflowProblem {
+    bool forward = true;
+    std::vector<BitSet> gen, kill, extra;
+};
+
+// in/out de cada bloco no sentido do programa (para trás, in é o que vale
+// no começo do bloco e out o que vale no fim)
+struct DataflowResult {
+    std::vector<BitSet> in, out;
+};
+
+inline DataflowResult solveDataflow(const IrFunction& fn, const DataflowProblem& p, size_t bits) {
+    size_t n = fn.blocks.size();
+    DataflowResult r;
+    r.in.assign(n, BitSet(bits));
+    r.out.assign(n, BitSet(bits));
+
+    // sem laços a ordem dos blocos é topológica e uma volta basta; o laço
+    // fica para grafos com arestas de volta
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < n; ++i) {
+            BlockId b = static_cast<BlockId>(p.forward ? i : n - 1 - i);
+            const IrBlock& block = fn.blocks[b];
+            BitSet meet = p.extra.empty() ? BitSet(bits) : p.extra[b];
+            if (p.forward) {
+                for (BlockId pred : block.preds) meet.unite(r.out[pred]);
+            } else {
+                for (BlockId succ : block.succs) meet.unite(r.in[succ]);
+            }
+            BitSet result = meet;
+            result.subtract(p.kill[b]);
+            result.unite(p.gen[b]);
+            BitSet& before = p.forward ? r.in[b] : r.out[b];
+            BitSet& after = p.forward ? r.out[b] : r.in[b];
+            if (result != after || meet != before) changed = true;
+            before = std::move(meet);
+            after = std::move(result);
+        }
+    }
+    return r;
+}
+
+// Valores SSA vivos na entrada e na saída de cada bloco (bit = ValueId)
+struct Liveness {
+    std::vector<BitSet> liveIn, liveOut;
+};
+
+inline Liveness computeLiveness(const IrFunction& fn) {
+    size_t n = fn.blocks.size();
+    size_t bits = fn.insts.size();
+    DataflowProblem p;
+    p.forward = false;
+    p.gen.assign(n, BitSet(bits));      // usados antes de definidos no bloco
+    p.kill.assign(n, BitSet(bits));     // definidos no bloco
+    p.extra.assign(n, BitSet(bits));
+    for (BlockId b = 0; b < n; ++b) {
+        for (ValueId id : fn.blocks[b].insts) {
+            const IrInst& in = fn.insts[id];
+            for (size_t k = 0; k < in.argCount; ++k) {
+                ValueId v = fn.arg(id, k);
+                if (in.op == IrOp::Phi) p.extra[fn.blocks[b].preds[k]].set(v);   // vivo na saída do predecessor
+                else if (!p.kill[b].test(v)) p.gen[b].set(v);
+            }
+            if (!fn.isTerminator(id)) p.kill[b].set(id);
+        }
+    }
+    DataflowResult r = solveDataflow(fn, p, bits);
+    return {std::move(r.in), std::move(r.out)};
+}
+
+// Escritas de variáveis (índices em IrFunction::writes) que alcançam a
+// entrada e a saída de cada bloco
+struct ReachingDefs {
+    std::vector<BitSet> in, out;
+};
+
+inline ReachingDefs computeReachingDefs(const IrFunction& fn) {
+    size_t n = fn.blocks.size();
+    size_t bits = fn.writes.size();
+    std::vector<BitSet> ofVar(fn.vars.size(), BitSet(bits));    // escritas de cada variável
+    for (size_t w = 0; w < bits; ++w) ofVar[fn.writes[w].var].set(w);
+
+    DataflowProblem p;
+    p.forward = true;
+    p.gen.assign(n, BitSet(bits));      // última escrita de cada variável no bloco
+    p.kill.assign(n, BitSet(bits));     // todas as escritas das variáveis escritas no bloco
+    for (size_t w = 0; w < bits; ++w) {
+        const IrWrite& wr = fn.writes[w];
+        p.kill[wr.block].unite(ofVar[wr.var]);
+        p.gen[wr.block].subtract(ofVar[wr.var]);
+        p.gen[wr.block].set(w);
+    }
+    DataflowResult r = solveDataflow(fn, p, bits);
+    return {std::move(r.in), std::move(r.out)};
+}
+
+// Cadeias uso-definição. Em SSA cada operando já é a própria definição
+// (IrFunction::arg); aqui fica o caminho inverso, as instruções que usam
+// cada valor, em CSR.
+class UseDefChains {
+public:
+    explicit UseDefChains(const IrFunction& fn) : offsets(fn.insts.size() + 1, 0) {
+        for (ValueId id = 0; id < fn.insts.size(); ++id) {
+            for (size_t k = 0; k < fn.argCount(id); ++k) ++offsets[fn.arg(id, k) + 1];
+        }
+        for (size_t v = 0; v < fn.insts.size(); ++v) offsets[v + 1] += offsets[v];
+        users.resize(offsets.back());
+        std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+        for (ValueId id = 0; id < fn.insts.size(); ++id) {
+            for (size_t k = 0; k < fn.argCount(id); ++k) users[next[fn.arg(id, k)]++] = id;
+        }
+    }
+
+    // Instruções que usam `v` (uma vez por operando)
+    size_t useCount(ValueId v) const { return offsets[v + 1] - offsets[v]; }
+    ValueId user(ValueId v, size_t k) const { return users[offsets[v] + k]; }
+
+private:
+    std::vector<uint32_t> offsets;
+    std::vector<ValueId> users;
+};
@@ -0,0 +1,412 @@
+// ir.cpp
+// Compiladores - Representação intermediária em SSA, construída a partir da
+// AST checada e especializada: blocos básicos com instruções tipadas, um
+// valor por instrução e phis nas junções de if. O aninhamento de If/Block
+// já é um grafo de fluxo estruturado, então a construção é uma passada só
+// pelos statements, na ordem de execução, com o valor atual de cada
+// variável por (escopo, slot).
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Valor SSA: índice da instrução que o define
+using ValueId = uint32_t;
+constexpr ValueId NO_VALUE = UINT32_MAX;
+
+using BlockId = uint32_t;
+constexpr BlockId NO_BLOCK = UINT32_MAX;
+
+// Variável do programa (ou temporário da CSE) que recebe valores
+constexpr uint32_t NO_VAR = UINT32_MAX;
+
+enum class IrOp : uint8_t {
+    Const,                             // literal (literals[literal])
+    Undef,                             // variável ainda sem valor no caminho
+    Binary,                            // operação especializada (exec)
+    Promote,                           // int -> real
+    Phi,                               // um operando por predecessor, na ordem de preds
+    Jump,                              // terminadores: sem valor
+    Branch,                            // args[0] = condição; succs = {então, senão}
+    Return                             // valores finais das variáveis do programa
+};
+
+struct IrInst {
+    IrOp op;
+    ExecOp exec;                       // Binary
+    TypeKind type;                     // tipo do valor (UNKNOWN nos terminadores)
+    BlockId block;
+    uint32_t firstArg;                 // operandos em args[firstArg, +argCount)
+    uint32_t argCount;
+    uint32_t var;                      // primeira variável escrita com o valor (NO_VAR se nenhuma)
+    uint32_t literal;                  // Const: índice em literals
+};
+
+struct IrBlock {
+    std::vector<ValueId> insts;        // phis primeiro, terminador por último
+    std::vector<BlockId> preds;
+    std::vector<BlockId> succs;
+};
+
+struct IrVar {
+    std::string_view name;
+    TypeKind type;
+    bool temp;                         // temporário da CSE (fora do Return)
+};
+
+// Escrita de uma variável (Decl, Assign, Temp ou phi), na ordem do
+// programa. Uma cópia `x = y` não gera instrução, então a mesma
+// instrução pode ser escrita em várias variáveis.
+struct IrWrite {
+    uint32_t var;
+    ValueId value;
+    BlockId block;
+};
+
+// Programa em SSA. O bloco 0 é a entrada e o único Return fica no último
+// bloco; como a linguagem não tem laços, a ordem dos blocos já é
+// topológica (toda aresta vai para um bloco de número maior).
+class IrFunction {
+public:
+    std::vector<IrInst> insts;
+    std::vector<ValueId> args;
+    std::vector<IrBlock> blocks;
+    std::vector<IrVar> vars;
+    std::vector<IrWrite> writes;
+    std::vector<uint32_t> results;        // variável de cada operando do Return
+    std::vector<LiteralValue> literals;   // textos apontam para a AST de origem
+
+    size_t argCount(ValueId id) const { return insts[id].argCount; }
+    ValueId arg(ValueId id, size_t k) const { return args[insts[id].firstArg + k]; }
+    bool isTerminator(ValueId id) const { return insts[id].op >= IrOp::Jump; }
+
+    BlockId addBlock() {
+        blocks.emplace_back();
+        return static_cast<BlockId>(blocks.size() - 1);
+    }
+
+    void addEdge(BlockId from, BlockId to) {
+        blocks[from].succs.push_back(to);
+        blocks[to].preds.push_back(from);
+    }
+
+    // Acrescenta uma instrução ao fim do bloco
+    ValueId add(BlockId block, IrOp op, TypeKind type, const ValueId* operands = nullptr, size_t count = 0,
+                uint32_t var = NO_VAR) {
+        ValueId id = static_cast<ValueId>(insts.size());
+        insts.push_back({op, ExecOp::None, type, block, static_cast<uint32_t>(args.size()),
+                         static_cast<uint32_t>(count), var, 0});
+        args.insert(args.end(), operands, operands + count);
+        blocks[block].insts.push_back(id);
+        return id;
+    }
+};
+
+// Valor atual de uma variável durante a construção
+struct IrDef {
+    ValueId value = NO_VALUE;
+    uint32_t var = NO_VAR;
+};
+
+// Constrói o SSA de um programa sem erros. O Return recebe o valor final
+// de cada variável do programa que tem valor no fim, na ordem dos slots.
+class IrBuilder {
+public:
+    IrBuilder(const AstPool& a, IrFunction& f) : ast(a), fn(f) {}
+
+    void run() {
+        if (ast.root == NO_NODE) return;
+        current = fn.addBlock();
+        env.pushFrame(ast.frameSize(ast.root));
+        statements(ast.root);
+
+        std::vector<ValueId> results;
+        for (uint32_t slot = 0; slot < ast.frameSize(ast.root); ++slot) {
+            IrDef d = env.get(0, slot);
+            if (d.value == NO_VALUE || fn.vars[d.var].temp) continue;
+            results.push_back(d.value);
+            fn.results.push_back(d.var);
+        }
+        fn.add(current, IrOp::Return, TypeKind::UNKNOWN, results.data(), results.size());
+    }
+
+private:
+    const AstPool& ast;
+    IrFunction& fn;
+    SlotEnv<IrDef> env;
+    BlockId current = NO_BLOCK;
+    std::vector<std::pair<NodeId, bool>> work;     // pilhas de expr
+    std::vector<ValueId> values;
+    ValueId undefs[5] = {NO_VALUE, NO_VALUE, NO_VALUE, NO_VALUE, NO_VALUE};   // por TypeKind
+
+    // Undef do tipo, criado uma vez no começo da entrada
+    ValueId undef(TypeKind t) {
+        ValueId& u = undefs[static_cast<size_t>(t)];
+        if (u == NO_VALUE) {
+            u = fn.add(0, IrOp::Undef, t);
+            std::vector<ValueId>& entry = fn.blocks[0].insts;
+            std::rotate(entry.begin(), entry.end() - 1, entry.end());
+        }
+        return u;
+    }
+
+    uint32_t addVar(NodeId id, bool temp) {
+        fn.vars.push_back({ast.value(id), ast.type(id), temp});
+        return static_cast<uint32_t>(fn.vars.size() - 1);
+    }
+
+    // Escreve `v` na variável do Identifier (ou Temp) `id`
+    void write(NodeId id, ValueId v, uint32_t var) {
+        if (fn.insts[v].var == NO_VAR && fn.insts[v].op != IrOp::Undef) fn.insts[v].var = var;
+        fn.writes.push_back({var, v, current});
+        env.set(ast.depth(id), ast.slot(id), {v, var});
+    }
+
+    // Instruções da expressão do filho k de `parent` (pós-ordem com pilhas
+    // explícitas, operandos da esquerda para a direita como no executor)
+    ValueId expr(NodeId parent, size_t k) {
+        size_t workBase = work.size();
+        size_t valueBase = values.size();
+        work.push_back({ast.child(parent, k), false});
+        while (work.size() > workBase) {
+            auto [node, expanded] = work.back();
+            work.pop_back();
+            NodeKind kind = ast.kind(node);
+            if (kind == NodeKind::Literal) {
+                ValueId c = fn.add(current, IrOp::Const, ast.type(node));
+                fn.insts[c].literal = static_cast<uint32_t>(fn.literals.size());
+                fn.literals.push_back(ast.literal(node));
+                values.push_back(c);
+            } else if (kind == NodeKind::Identifier) {
+                ValueId v = env.get(ast.depth(node), ast.slot(node)).value;
+                values.push_back(v != NO_VALUE ? v : undef(ast.type(node)));
+            } else if (!expanded) {
+                work.push_back({node, true});
+                for (size_t i = ast.childCount(node); i-- > 0;) work.push_back({ast.child(node, i), false});
+            } else if (kind == NodeKind::Promote) {
+                values.back() = fn.add(current, IrOp::Promote, TypeKind::REAL, &values.back(), 1);
+            } else if (kind == NodeKind::Temp) {           // o valor do filho vai para o temporário
+                IrDef d = env.get(ast.depth(node), ast.slot(node));
+                write(node, values.back(), d.var != NO_VAR ? d.var : addVar(node, true));
+            } else {                                       // Binary
+                ValueId operands[2] = {values[values.size() - 2], values.back()};
+                values.pop_back();
+                values.back() = fn.add(current, IrOp::Binary, ast.type(node), operands, 2);
+                fn.insts[values.back()].exec = ast.exec(node);
+            }
+        }
+        ValueId v = values.back();
+        values.resize(valueBase);
+        return v;
+    }
+
+    void statements(NodeId node) {
+        for (size_t i = 0; i < ast.childCount(node); ++i) statement(ast.child(node, i));
+    }
+
+    void statement(NodeId node) {
+        switch (ast.kind(node)) {
+            case NodeKind::Block:
+                env.pushFrame(ast.frameSize(node));
+                statements(node);
+                env.popFrame();
+                break;
+
+            // sem inicializador, a variável começa com o valor padrão do tipo
+            case NodeKind::Decl: {
+                NodeId var = ast.child(node, 0);
+                ValueId v;
+                if (ast.childCount(node) > 1) {
+                    v = expr(node, 1);
+                } else {
+                    v = fn.add(current, IrOp::Const, ast.type(var));
+                    fn.insts[v].literal = static_cast<uint32_t>(fn.literals.size());
+                    LiteralValue zero;
+                    zero.type = ast.type(var);
+                    fn.literals.push_back(zero);
+                }
+                write(var, v, addVar(var, false));
+                break;
+            }
+
+            case NodeKind::Assign: {
+                NodeId var = ast.child(node, 0);
+                ValueId v = expr(node, 1);
+                write(var, v, env.get(ast.depth(var), ast.slot(var)).var);
+                break;
+            }
+
+            case NodeKind::If:
+                ifStatement(node);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    // Lowering de um ramo a partir de `from`: devolve o bloco onde o ramo
+    // termina e as escritas dele em variáveis de fora
+    BlockId branch(NodeId node, size_t k, BlockId from, SlotEnv<IrDef>::Writes& writes) {
+        BlockId start = fn.addBlock();
+        fn.addEdge(from, start);
+        current = start;
+        size_t m = env.mark();
+        statement(ast.child(node, k));
+        writes = env.writesSince(m, env.depth());
+        env.undo(m);
+        return current;
+    }
+
+    // cond -> então [-> senão] -> junção, com um phi por variável que os
+    // caminhos deixam com valores diferentes
+    void ifStatement(NodeId node) {
+        ValueId cond = expr(node, 0);
+        BlockId head = current;
+        fn.add(head, IrOp::Branch, TypeKind::UNKNOWN, &cond, 1);
+
+        SlotEnv<IrDef>::Writes thenWrites, elseWrites;
+        BlockId thenEnd = branch(node, 1, head, thenWrites);
+        BlockId elseEnd = ast.childCount(node) > 2 ? branch(node, 2, head, elseWrites) : NO_BLOCK;
+
+        BlockId join = fn.addBlock();
+        fn.add(thenEnd, IrOp::Jump, TypeKind::UNKNOWN);
+        fn.addEdge(thenEnd, join);
+        if (elseEnd != NO_BLOCK) {
+            fn.add(elseEnd, IrOp::Jump, TypeKind::UNKNOWN);
+            fn.addEdge(elseEnd, join);
+        } else {
+            fn.addEdge(head, join);                 // condição falsa
+        }
+        current = join;
+
+        // chaves em ordem, para a saída não depender do hash
+        std::vector<uint64_t> keys;
+        for (const auto* writes : {&thenWrites, &elseWrites}) {
+            for (const auto& w : *writes) keys.push_back(w.first);
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        auto defAfter = [&](const SlotEnv<IrDef>::Writes& writes, uint64_t key) {
+            auto it = writes.find(key);
+            return it != writes.end() ? it->second : env.get(static_cast<uint16_t>(key >> 32), static_cast<uint32_t>(key));
+        };
+        for (uint64_t key : keys) {
+            IrDef a = defAfter(thenWrites, key);
+            IrDef b = defAfter(elseWrites, key);
+            uint16_t depth = static_cast<uint16_t>(key >> 32);
+            uint32_t slot = static_cast<uint32_t>(key);
+            uint32_t var = a.var != NO_VAR ? a.var : b.var;
+            if (a.value == b.value) {
+                env.set(depth, slot, a);
+                continue;
+            }
+            TypeKind t = fn.vars[var].type;
+            ValueId operands[2] = {a.value != NO_VALUE ? a.value : undef(t), b.value != NO_VALUE ? b.value : undef(t)};
+            ValueId phi = fn.add(join, IrOp::Phi, t, operands, 2, var);
+            fn.writes.push_back({var, phi, join});
+            env.set(depth, slot, {phi, var});
+        }
+    }
+};
+
+// SSA do programa inteiro (AST sem erros, já especializada)
+inline IrFunction buildIr(const AstPool& ast) {
+    IrFunction fn;
+    IrBuilder builder(ast, fn);
+    builder.run();
+    return fn;
+}
+
+// Nome de uma operação especializada no texto do IR
+static const char* irOpName(ExecOp op) {
+    switch (op) {
+        case ExecOp::AddInt:  return "add.i";
+        case ExecOp::SubInt:  return "sub.i";
+        case ExecOp::MulInt:  return "mul.i";
+        case ExecOp::DivInt:  return "div.i";
+        case ExecOp::ModInt:  return "mod.i";
+        case ExecOp::AddReal: return "add.r";
+        case ExecOp::SubReal: return "sub.r";
+        case ExecOp::MulReal: return "mul.r";
+        case ExecOp::DivReal: return "div.r";
+        case ExecOp::EqInt:   return "eq.i";
+        case ExecOp::NeInt:   return "ne.i";
+        case ExecOp::LtInt:   return "lt.i";
+        case ExecOp::LeInt:   return "le.i";
+        case ExecOp::GtInt:   return "gt.i";
+        case ExecOp::GeInt:   return "ge.i";
+        case ExecOp::EqReal:  return "eq.r";
+        case ExecOp::NeReal:  return "ne.r";
+        case ExecOp::LtReal:  return "lt.r";
+        case ExecOp::LeReal:  return "le.r";
+        case ExecOp::GtReal:  return "gt.r";
+        case ExecOp::GeReal:  return "ge.r";
+        case ExecOp::And:     return "and";
+        case ExecOp::Or:      return "or";
+        default:              return "?";
+    }
+}
+
+static const char* irTypeName(TypeKind t) {
+    switch (t) {
+        case TypeKind::INT:    return "int";
+        case TypeKind::REAL:   return "real";
+        case TypeKind::STRING: return "string";
+        case TypeKind::BOOL:   return "bool";
+        default:               return "?";
+    }
+}
+
+// Uma instrução em texto: "%3 = int add.i %1, %2  ; a"
+inline void printIrInst(std::ostream& out, const IrFunction& fn, ValueId id) {
+    const IrInst& in = fn.insts[id];
+    auto operands = [&](size_t from) {
+        for (size_t k = from; k < in.argCount; ++k) out << (k > from ? ", %" : " %") << fn.arg(id, k);
+    };
+    switch (in.op) {
+        case IrOp::Jump:
+            out << "jmp b" << fn.blocks[in.block].succs[0];
+            return;
+        case IrOp::Branch:
+            out << "br %" << fn.arg(id, 0) << ", b" << fn.blocks[in.block].succs[0] << ", b" << fn.blocks[in.block].succs[1];
+            return;
+        case IrOp::Return:
+            out << "ret";
+            for (size_t k = 0; k < in.argCount; ++k) {
+                out << (k ? ", " : " ") << fn.vars[fn.results[k]].name << "=%" << fn.arg(id, k);
+            }
+            return;
+        default:
+            break;
+    }
+
+    out << "%" << id << " = " << irTypeName(in.type) << " ";
+    switch (in.op) {
+        case IrOp::Const: {
+            const LiteralValue& lit = fn.literals[in.literal];
+            switch (lit.type) {
+                case TypeKind::INT:    out << lit.i; break;
+                case TypeKind::REAL:   out << lit.d; break;
+                case TypeKind::STRING: out << (lit.s.empty() ? "\"\"" : lit.s); break;
+                case TypeKind::BOOL:   out << (lit.b ? "true" : "false"); break;
+                default:               out << "?"; break;
+            }
+            if (lit.outOfRange) out << " (fora da faixa)";
+            break;
+        }
+        case IrOp::Undef:   out << "undef"; break;
+        case IrOp::Promote: out << "promote"; operands(0); break;
+        case IrOp::Binary:  out << irOpName(in.exec); operands(0); break;
+        case IrOp::Phi: {
+            out << "phi";
+            const std::vector<BlockId>& preds = fn.blocks[in.block].preds;
+            for (size_t k = 0; k < in.argCount; ++k) out << (k ? ", " : " ") << "[%" << fn.arg(id, k) << ", b" << preds[k] << "]";
+            break;
+        }
+        default:
+            break;
+    }
+    if (in.var != NO_VAR) out << "  ; " << fn.vars[in.var].name;
+}
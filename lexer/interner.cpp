@@ -0,0 +1,83 @@
+// interner.cpp
+// Compiladores - Tabela de nomes: cada identificador vira um id inteiro denso
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Id de um nome interno (0, 1, 2, ... na ordem da primeira ocorrência)
+using SymbolId = uint32_t;
+constexpr SymbolId NO_SYMBOL = UINT32_MAX;
+
+// Interner preenchido pelo lexer. As fases seguintes comparam e indexam
+// pelos ids; o texto só é recuperado para mensagens e para o estado final.
+class Interner {
+public:
+    Interner() = default;
+    Interner(Interner&&) = default;
+    Interner& operator=(Interner&&) = default;
+    Interner(const Interner&) = delete;             // `names` aponta para `storage`
+    Interner& operator=(const Interner&) = delete;
+
+    // id do nome, criando um novo na primeira vez
+    SymbolId intern(std::string_view name) {
+        if ((names.size() + 1) * 2 > slots.size()) grow();
+        uint32_t h = hashName(name);
+        size_t mask = slots.size() - 1;
+        for (size_t k = h & mask;; k = (k + 1) & mask) {
+            Slot& s = slots[k];
+            if (s.id == NO_SYMBOL) {
+                SymbolId id = static_cast<SymbolId>(names.size());
+                storage.emplace_back(name);
+                names.push_back(storage.back());
+                s = {h, id};
+                return id;
+            }
+            if (s.hash == h && names[s.id] == name) return s.id;
+        }
+    }
+
+    // id de um nome já interno, ou NO_SYMBOL
+    SymbolId find(std::string_view name) const {
+        if (slots.empty()) return NO_SYMBOL;
+        uint32_t h = hashName(name);
+        size_t mask = slots.size() - 1;
+        for (size_t k = h & mask;; k = (k + 1) & mask) {
+            const Slot& s = slots[k];
+            if (s.id == NO_SYMBOL) return NO_SYMBOL;
+            if (s.hash == h && names[s.id] == name) return s.id;
+        }
+    }
+
+    std::string_view name(SymbolId id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+
+private:
+    struct Slot {
+        uint32_t hash;
+        SymbolId id;
+    };
+    std::vector<Slot> slots;                // endereçamento aberto, potência de 2
+    std::vector<std::string_view> names;    // id -> texto
+    std::deque<std::string> storage;        // cópias estáveis dos nomes
+
+    // FNV-1a
+    static uint32_t hashName(std::string_view s) {
+        uint32_t h = 2166136261u;
+        for (unsigned char c : s) { h ^= c; h *= 16777619u; }
+        return h;
+    }
+
+    void grow() {
+        std::vector<Slot> bigger(slots.empty() ? 64 : slots.size() * 2, Slot{0, NO_SYMBOL});
+        size_t mask = bigger.size() - 1;
+        for (const Slot& s : slots) {
+            if (s.id == NO_SYMBOL) continue;
+            size_t k = s.hash & mask;
+            while (bigger[k].id != NO_SYMBOL) k = (k + 1) & mask;
+            bigger[k] = s;
+        }
+        slots.swap(bigger);
+    }
+};
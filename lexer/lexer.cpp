@@ -5,36 +5,212 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_set>
-#include <cctype>
+#include <memory>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
 #include <stdexcept>
+#include "simd.cpp"
+#include "interner.cpp"
+#include "../util/thread_pool.cpp"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
 // Definição dos tipos de tokens
-enum class TokenType {
+// Cada operador, pontuação e palavra-chave tem o seu próprio tipo, então o
+// parser decide comparando inteiros. As categorias impressas em --tokens
+// (OPERADOR, PONTUACAO, KEYWORD) saem de isOperator/isPunctuation/isKeywordType.
+enum class TokenType : uint8_t {
     IDENTIFIER,
     NUM_INT,
     NUM_REAL,
     STRING,
-    KEYWORD,
-    OPERATOR,
-    PUNCTUATION,
     END_OF_FILE,
     UNKNOWN,
-    COMMENT
+    COMMENT,
+
+    // operadores
+    OP_PLUS,        // +
+    OP_MINUS,       // -
+    OP_STAR,        // *
+    OP_SLASH,       // /
+    OP_PERCENT,     // %
+    OP_ASSIGN,      // =
+    OP_EQ,          // ==
+    OP_NE,          // !=
+    OP_LT,          // <
+    OP_LE,          // <=
+    OP_GT,          // >
+    OP_GE,          // >=
+    OP_AND,         // &&
+    OP_OR,          // ||
+
+    // pontuação
+    LPAREN,         // (
+    RPAREN,         // )
+    SEMICOLON,      // ;
+    COMMA,          // ,
+    LBRACE,         // {
+    RBRACE,         // }
+    LBRACKET,       // [
+    RBRACKET,       // ]
+
+    // palavras-chave
+    KW_IF, KW_ELSE, KW_WHILE, KW_FOR, KW_SWITCH, KW_CASE, KW_RETURN,
+    KW_INT, KW_FLOAT, KW_STRING, KW_BOOLEAN, KW_VOID, KW_BREAK,
+    KW_CONTINUE, KW_TRUE, KW_FALSE, KW_NULL, KW_DO, KW_ENUM, KW_STRUCT,
+    KW_TYPEDEF, KW_CONST, KW_STATIC, KW_PUBLIC, KW_PRIVATE, KW_PROTECTED,
+    KW_CLASS, KW_NEW, KW_THIS, KW_SUPER, KW_IMPORT, KW_PACKAGE, KW_INCLUDE,
+
+    COUNT
+};
+
+constexpr bool isOperator(TokenType t) { return t >= TokenType::OP_PLUS && t <= TokenType::OP_OR; }
+constexpr bool isPunctuation(TokenType t) { return t >= TokenType::LPAREN && t <= TokenType::RBRACKET; }
+constexpr bool isKeywordType(TokenType t) { return t >= TokenType::KW_IF && t < TokenType::COUNT; }
+
+// Buffer com o código fonte. Para arquivos usa mapeamento em memória
+// (mmap / MapViewOfFile), sem cópia; os tokens guardam views para dentro
+// dele, então o buffer precisa viver enquanto parser, semântica e executor
+// usarem os tokens.
+class SourceBuffer {
+public:
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+    ~SourceBuffer() {
+#ifdef _WIN32
+        if (view) UnmapViewOfFile(view);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (mapped) munmap(mapped, mappedSize);
+#endif
+    }
+
+    // Mapeia o arquivo em memória; se o mapeamento não for possível
+    // (arquivo vazio, pipe, etc.), lê o conteúdo para um buffer próprio
+    static shared_ptr<SourceBuffer> fromFile(const string& filename) {
+        shared_ptr<SourceBuffer> buf(new SourceBuffer());
+        if (buf->mapFile(filename)) return buf;
+
+        ifstream file(filename, ios::binary);
+        if (!file) {
+            throw runtime_error("Nao foi possivel abrir: " + filename);
+        }
+        stringstream ss;
+        ss << file.rdbuf();
+        buf->owned = ss.str();
+        buf->data = buf->owned;
+        return buf;
+    }
+
+    // Buffer em memória a partir de uma string
+    static shared_ptr<SourceBuffer> fromString(string text) {
+        shared_ptr<SourceBuffer> buf(new SourceBuffer());
+        buf->owned = move(text);
+        buf->data = buf->owned;
+        return buf;
+    }
+
+    string_view text() const { return data; }
+    bool isMapped() const {
+#ifdef _WIN32
+        return view != nullptr;
+#else
+        return mapped != nullptr;
+#endif
+    }
+
+private:
+    SourceBuffer() = default;
+
+    string_view data;
+    string owned;                          // usado quando não há mapeamento
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+    void* view = nullptr;
+
+    bool mapFile(const string& filename) {
+        file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) return false;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return false;
+        view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!view) return false;
+        data = string_view(static_cast<const char*>(view), static_cast<size_t>(size.QuadPart));
+        return true;
+    }
+#else
+    void* mapped = nullptr;
+    size_t mappedSize = 0;
+
+    bool mapFile(const string& filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+            close(fd);
+            return false;
+        }
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);                         // o mapeamento continua válido sem o descritor
+        if (p == MAP_FAILED) return false;
+        madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+        mapped = p;
+        mappedSize = static_cast<size_t>(st.st_size);
+        data = string_view(static_cast<const char*>(p), mappedSize);
+        return true;
+    }
+#endif
 };
 
 // Estrutura dos tokens
+// O texto é uma view para dentro do SourceBuffer (ou um literal estático,
+// como "<EOF>"), então copiar um Token não aloca memória. Identificadores
+// carregam o id do nome no Interner do lexer.
 struct Token {
     TokenType tipo;
-    string texto;
+    SymbolId simbolo;
+    string_view texto;
     int linha;
     int coluna;
 
-    Token() : tipo(TokenType::UNKNOWN), texto(""), linha(0), coluna(0) {}
-    Token(TokenType t, string l, int ln, int col): tipo(t), texto(move(l)), linha(ln), coluna(col) {}
+    Token() : tipo(TokenType::UNKNOWN), simbolo(NO_SYMBOL), texto(""), linha(0), coluna(0) {}
+    Token(TokenType t, string_view l, int ln, int col, SymbolId sym = NO_SYMBOL)
+        : tipo(t), simbolo(sym), texto(l), linha(ln), coluna(col) {}
+
+    // Texto para exibição; uma string não fechada (UNKNOWN começando com
+    // aspas) carrega o aviso junto ao lexema
+    string lexema() const {
+        string s(texto);
+        if (tipo == TokenType::UNKNOWN && !texto.empty() && texto[0] == '"') {
+            s += "(String nunca foi fechada)";
+        }
+        return s;
+    }
 
     string toString() const {
         auto tt = [](TokenType t) {
@@ -43,63 +219,387 @@ struct Token {
                 case TokenType::NUM_INT:     return "NUM_INT";
                 case TokenType::NUM_REAL:    return "NUM_REAL";
                 case TokenType::STRING:      return "STRING";
-                case TokenType::KEYWORD:     return "KEYWORD";
-                case TokenType::OPERATOR:    return "OPERADOR";
-                case TokenType::PUNCTUATION: return "PONTUACAO";
                 case TokenType::END_OF_FILE: return "FIM DE ARQUIVO";
                 case TokenType::UNKNOWN:     return "UNKNOWN";
                 case TokenType::COMMENT:     return "COMMENTARIO";
+                default:
+                    if (isOperator(t))    return "OPERADOR";
+                    if (isPunctuation(t)) return "PONTUACAO";
+                    if (isKeywordType(t)) return "KEYWORD";
             }
             return "TOKEN";
         };
-        return string(tt(tipo)) + " -> \"" + texto + "\" [" +
+        return string(tt(tipo)) + " -> \"" + lexema() + "\" [" +
                to_string(linha) + "," + to_string(coluna) + "]";
     }
 };
 
+// ===== Tabelas do scanner (montadas em tempo de compilação) =====
+
+// Classes de caractere usadas pelo autômato
+enum class CharClass : uint8_t {
+    OTHER,      // caractere desconhecido
+    END,        // fim do buffer ou byte nulo
+    SPACE,      // ' ' e '\t'
+    NEWLINE,    // '\n'
+    CR,         // '\r' (espaço só quando seguido de '\n')
+    ALPHA,      // letras e '_'
+    DIGIT,
+    DOT,
+    QUOTE,
+    BACKSLASH,
+    SLASH,
+    EQ,
+    BANG,
+    LT,
+    GT,
+    AMP,
+    PIPE,
+    OP,         // + - * %
+    PUNCT,      // ( ) ; , { } [ ]
+    COUNT
+};
+
+// Estados do autômato; Stop encerra o token sem consumir o caractere
+enum class ScanState : uint8_t {
+    Start,
+    Ident,
+    Int,
+    IntDot,     // dígitos + '.', ainda sem dígito depois do ponto
+    Real,
+    Str,
+    StrEsc,
+    StrEnd,
+    Slash,
+    Comment,
+    Eq,
+    Bang,
+    Lt,
+    Gt,
+    Amp,
+    Pipe,
+    OpEnd,      // operador completo (simples ou duplo)
+    PunctEnd,
+    UnknownEnd,
+    Stop,
+    COUNT
+};
+
+constexpr size_t CHAR_CLASSES = static_cast<size_t>(CharClass::COUNT);
+constexpr size_t SCAN_STATES  = static_cast<size_t>(ScanState::COUNT);
+
+constexpr array<CharClass, 256> makeCharClassTable() {
+    array<CharClass, 256> t{};
+    for (auto& c : t) c = CharClass::OTHER;
+    t[0] = CharClass::END;
+    t[' '] = CharClass::SPACE;
+    t['\t'] = CharClass::SPACE;
+    t['\n'] = CharClass::NEWLINE;
+    t['\r'] = CharClass::CR;
+    for (int c = 'a'; c <= 'z'; ++c) t[c] = CharClass::ALPHA;
+    for (int c = 'A'; c <= 'Z'; ++c) t[c] = CharClass::ALPHA;
+    t['_'] = CharClass::ALPHA;
+    for (int c = '0'; c <= '9'; ++c) t[c] = CharClass::DIGIT;
+    t['.'] = CharClass::DOT;
+    t['"'] = CharClass::QUOTE;
+    t['\\'] = CharClass::BACKSLASH;
+    t['/'] = CharClass::SLASH;
+    t['='] = CharClass::EQ;
+    t['!'] = CharClass::BANG;
+    t['<'] = CharClass::LT;
+    t['>'] = CharClass::GT;
+    t['&'] = CharClass::AMP;
+    t['|'] = CharClass::PIPE;
+    for (char c : {'+', '-', '*', '%'}) t[static_cast<unsigned char>(c)] = CharClass::OP;
+    for (char c : {'(', ')', ';', ',', '{', '}', '[', ']'}) t[static_cast<unsigned char>(c)] = CharClass::PUNCT;
+    return t;
+}
+
+using TransitionTable = array<array<ScanState, CHAR_CLASSES>, SCAN_STATES>;
+
+constexpr TransitionTable makeTransitionTable() {
+    TransitionTable t{};
+    auto set = [&t](ScanState s, CharClass c, ScanState to) {
+        t[static_cast<size_t>(s)][static_cast<size_t>(c)] = to;
+    };
+    auto setAll = [&t](ScanState s, ScanState to) {
+        for (auto& x : t[static_cast<size_t>(s)]) x = to;
+    };
+    for (size_t s = 0; s < SCAN_STATES; ++s) setAll(static_cast<ScanState>(s), ScanState::Stop);
+
+    // primeiro caractere do token (espaços já foram pulados)
+    setAll(ScanState::Start, ScanState::UnknownEnd);
+    set(ScanState::Start, CharClass::END, ScanState::Stop);
+    set(ScanState::Start, CharClass::ALPHA, ScanState::Ident);
+    set(ScanState::Start, CharClass::DIGIT, ScanState::Int);
+    set(ScanState::Start, CharClass::QUOTE, ScanState::Str);
+    set(ScanState::Start, CharClass::SLASH, ScanState::Slash);
+    set(ScanState::Start, CharClass::EQ, ScanState::Eq);
+    set(ScanState::Start, CharClass::BANG, ScanState::Bang);
+    set(ScanState::Start, CharClass::LT, ScanState::Lt);
+    set(ScanState::Start, CharClass::GT, ScanState::Gt);
+    set(ScanState::Start, CharClass::AMP, ScanState::Amp);
+    set(ScanState::Start, CharClass::PIPE, ScanState::Pipe);
+    set(ScanState::Start, CharClass::OP, ScanState::OpEnd);
+    set(ScanState::Start, CharClass::PUNCT, ScanState::PunctEnd);
+
+    // identificadores
+    set(ScanState::Ident, CharClass::ALPHA, ScanState::Ident);
+    set(ScanState::Ident, CharClass::DIGIT, ScanState::Ident);
+
+    // números: um único '.' seguido de dígito torna o número real
+    set(ScanState::Int, CharClass::DIGIT, ScanState::Int);
+    set(ScanState::Int, CharClass::DOT, ScanState::IntDot);
+    set(ScanState::IntDot, CharClass::DIGIT, ScanState::Real);
+    set(ScanState::Real, CharClass::DIGIT, ScanState::Real);
+
+    // strings com escape por '\'; END dentro da string = string não fechada
+    setAll(ScanState::Str, ScanState::Str);
+    set(ScanState::Str, CharClass::END, ScanState::Stop);
+    set(ScanState::Str, CharClass::BACKSLASH, ScanState::StrEsc);
+    set(ScanState::Str, CharClass::QUOTE, ScanState::StrEnd);
+    setAll(ScanState::StrEsc, ScanState::Str);
+    set(ScanState::StrEsc, CharClass::END, ScanState::Stop);
+
+    // '/' ou comentário de linha
+    set(ScanState::Slash, CharClass::SLASH, ScanState::Comment);
+    setAll(ScanState::Comment, ScanState::Comment);
+    set(ScanState::Comment, CharClass::END, ScanState::Stop);
+    set(ScanState::Comment, CharClass::NEWLINE, ScanState::Stop);
+
+    // operadores de dois caracteres
+    set(ScanState::Eq, CharClass::EQ, ScanState::OpEnd);
+    set(ScanState::Bang, CharClass::EQ, ScanState::OpEnd);
+    set(ScanState::Lt, CharClass::EQ, ScanState::OpEnd);
+    set(ScanState::Gt, CharClass::EQ, ScanState::OpEnd);
+    set(ScanState::Amp, CharClass::AMP, ScanState::OpEnd);
+    set(ScanState::Pipe, CharClass::PIPE, ScanState::OpEnd);
+    return t;
+}
+
+// Estado de aceitação: tipo do token reconhecido ao parar naquele estado.
+// Em OpEnd/PunctEnd o tipo depende do lexema (ver symbolKind).
+struct ScanAccept {
+    bool ok;
+    TokenType tipo;
+    bool byText;
+};
+
+constexpr array<ScanAccept, SCAN_STATES> makeAcceptTable() {
+    array<ScanAccept, SCAN_STATES> t{};
+    for (auto& a : t) a = {false, TokenType::UNKNOWN, false};
+    auto set = [&t](ScanState s, TokenType tipo) { t[static_cast<size_t>(s)] = {true, tipo, false}; };
+    set(ScanState::Ident, TokenType::IDENTIFIER);
+    set(ScanState::Int, TokenType::NUM_INT);
+    set(ScanState::Real, TokenType::NUM_REAL);
+    set(ScanState::StrEnd, TokenType::STRING);
+    set(ScanState::Slash, TokenType::OP_SLASH);
+    set(ScanState::Comment, TokenType::COMMENT);
+    set(ScanState::Eq, TokenType::OP_ASSIGN);
+    set(ScanState::Lt, TokenType::OP_LT);
+    set(ScanState::Gt, TokenType::OP_GT);
+    set(ScanState::Bang, TokenType::UNKNOWN);
+    set(ScanState::Amp, TokenType::UNKNOWN);
+    set(ScanState::Pipe, TokenType::UNKNOWN);
+    set(ScanState::UnknownEnd, TokenType::UNKNOWN);
+    t[static_cast<size_t>(ScanState::OpEnd)] = {true, TokenType::UNKNOWN, true};
+    t[static_cast<size_t>(ScanState::PunctEnd)] = {true, TokenType::UNKNOWN, true};
+    return t;
+}
+
+// Tipo de operadores/pontuação pelo lexema: tabela do primeiro caractere
+// para lexemas de 1 byte e outra para os de 2 bytes (==, !=, <=, >=, &&, ||)
+struct SymbolKinds {
+    array<TokenType, 256> single{};
+    array<TokenType, 256> pair{};
+};
+
+constexpr SymbolKinds makeSymbolKinds() {
+    SymbolKinds k{};
+    for (auto& x : k.single) x = TokenType::UNKNOWN;
+    for (auto& x : k.pair) x = TokenType::UNKNOWN;
+    auto one = [&k](char c, TokenType t) { k.single[static_cast<unsigned char>(c)] = t; };
+    auto two = [&k](char c, TokenType t) { k.pair[static_cast<unsigned char>(c)] = t; };
+    one('+', TokenType::OP_PLUS);    one('-', TokenType::OP_MINUS);
+    one('*', TokenType::OP_STAR);    one('/', TokenType::OP_SLASH);
+    one('%', TokenType::OP_PERCENT); one('=', TokenType::OP_ASSIGN);
+    one('<', TokenType::OP_LT);      one('>', TokenType::OP_GT);
+    one('(', TokenType::LPAREN);     one(')', TokenType::RPAREN);
+    one(';', TokenType::SEMICOLON);  one(',', TokenType::COMMA);
+    one('{', TokenType::LBRACE);     one('}', TokenType::RBRACE);
+    one('[', TokenType::LBRACKET);   one(']', TokenType::RBRACKET);
+    two('=', TokenType::OP_EQ);      two('!', TokenType::OP_NE);
+    two('<', TokenType::OP_LE);      two('>', TokenType::OP_GE);
+    two('&', TokenType::OP_AND);     two('|', TokenType::OP_OR);
+    return k;
+}
+
+constexpr array<CharClass, 256> CHAR_CLASS = makeCharClassTable();
+constexpr TransitionTable SCAN_TRANSITIONS = makeTransitionTable();
+constexpr array<ScanAccept, SCAN_STATES> SCAN_ACCEPT = makeAcceptTable();
+constexpr SymbolKinds SYMBOL_KINDS = makeSymbolKinds();
+
+// tipo de um operador/pontuação já reconhecido pelo autômato
+inline TokenType symbolKind(string_view lex) {
+    unsigned char c = static_cast<unsigned char>(lex[0]);
+    return lex.size() == 1 ? SYMBOL_KINDS.single[c] : SYMBOL_KINDS.pair[c];
+}
+
+// ===== Palavras-chave: hash perfeito calculado em tempo de compilação =====
+
+// mesma ordem de KW_IF..KW_INCLUDE em TokenType
+constexpr string_view KEYWORDS[] = {
+    "if", "else", "while", "for", "switch", "case", "return",
+    "int", "float", "string", "boolean", "void", "break",
+    "continue", "true", "false", "null", "do", "enum", "struct",
+    "typedef", "const", "static", "public", "private", "protected",
+    "class", "new", "this", "super", "import", "package", "include"
+};
+static_assert(size(KEYWORDS) == static_cast<size_t>(TokenType::COUNT) - static_cast<size_t>(TokenType::KW_IF),
+              "KEYWORDS fora de sincronia com TokenType");
+constexpr size_t KEYWORD_TABLE = 64;       // potência de 2
+constexpr size_t KEYWORD_MIN_LEN = 2;
+constexpr size_t KEYWORD_MAX_LEN = 9;
+
+// hash sobre primeiro, segundo e último caractere e o tamanho; os
+// coeficientes foram escolhidos para não haver colisão entre as keywords
+constexpr size_t keywordHash(string_view w) {
+    return (3u * static_cast<unsigned char>(w[0]) +
+            57u * static_cast<unsigned char>(w[1]) +
+            39u * static_cast<unsigned char>(w[w.size() - 1]) +
+            w.size()) & (KEYWORD_TABLE - 1);
+}
+
+struct KeywordTable {
+    array<string_view, KEYWORD_TABLE> slots{};
+    array<TokenType, KEYWORD_TABLE> kinds{};
+    bool perfect = true;
+};
+
+constexpr KeywordTable makeKeywordTable() {
+    KeywordTable t{};
+    for (size_t k = 0; k < size(KEYWORDS); ++k) {
+        string_view w = KEYWORDS[k];
+        size_t h = keywordHash(w);
+        if (!t.slots[h].empty()) t.perfect = false;
+        t.slots[h] = w;
+        t.kinds[h] = static_cast<TokenType>(static_cast<size_t>(TokenType::KW_IF) + k);
+    }
+    return t;
+}
+
+constexpr KeywordTable KEYWORD_TABLE_DATA = makeKeywordTable();
+static_assert(KEYWORD_TABLE_DATA.perfect, "hash de palavras-chave com colisao");
+
+// Tipo da palavra-chave, ou IDENTIFIER se não for uma (um acesso + uma comparação)
+inline TokenType keywordKind(string_view lex) {
+    if (lex.size() < KEYWORD_MIN_LEN || lex.size() > KEYWORD_MAX_LEN) return TokenType::IDENTIFIER;
+    size_t h = keywordHash(lex);
+    return KEYWORD_TABLE_DATA.slots[h] == lex ? KEYWORD_TABLE_DATA.kinds[h] : TokenType::IDENTIFIER;
+}
+
 // Analisador Léxico
+// Scanner dirigido por tabelas: classes de caractere + transições do
+// autômato, com o maior lexema aceito (maximal munch).
 class Lexer {
-    string src;
+    string_view src;
     size_t i = 0;
     int line = 1;
     int col = 1;
+    const ScanKernels* simd = &scanKernels();   // laços quentes em SIMD
+    shared_ptr<Interner> ownSymbols;            // só quando ninguém passou um interner
+    Interner* symbols;
 
-    // Conjunto de palavras-chave
-    unordered_set<string> keywords = {
-        "if", "else", "while", "for", "switch", "case", "return",
-        "int", "float", "string", "boolean", "void", "break",
-        "continue", "true", "false", "null", "do", "enum", "struct",
-        "typedef", "const", "static", "public", "private", "protected",
-        "class", "new", "this", "super", "import", "package", "include"
-    };
+    // classe do caractere na posição k (END fora do buffer)
+    CharClass classAt(size_t k) const {
+        if (k >= src.size()) return CharClass::END;
+        return CHAR_CLASS[static_cast<unsigned char>(src[k])];
+    }
 
-    // espia o próximo caractere sem consumir
-    char peek(size_t k = 0) const {
-        if (i + k >= src.size()) return '\0';
-        return src.at(i + k);
+    // avança até `to`, atualizando linha/coluna pelo trecho consumido;
+    // as quebras de linha são contadas em bloco
+    void advanceTo(size_t to, bool mayHaveNewline) {
+        if (mayHaveNewline) {
+            size_t lines = simd->countNewlines(src.data() + i, to - i);
+            if (lines) {
+                size_t lastNl = to - 1;
+                while (src[lastNl] != '\n') lastNl--;
+                line += static_cast<int>(lines);
+                col = 1 + static_cast<int>(to - lastNl - 1);
+                i = to;
+                return;
+            }
+        }
+        col += static_cast<int>(to - i);
+        i = to;
     }
 
-    // consome e retorna o próximo caractere
-    char get() {
-        if (i >= src.size()) return '\0';
-        char c = src[i++];
-        if (c == '\n') {
-            line++;
-            col = 1;
-        } else {
-            col++;
+    // sequências curtas são tratadas byte a byte; a partir deste tamanho
+    // (indentação longa, identificadores/comentários/strings grandes) o
+    // restante vai para os kernels SIMD
+    static constexpr size_t SHORT_RUN = 16;
+
+    // pula espaços, '\n' e CRLF; para em '\r' isolado
+    void skipWhitespace() {
+        size_t n = src.size();
+        size_t seen = 0;
+        while (i < n) {
+            char c = src[i];
+            if (c == ' ' || c == '\t') { i++; col++; }
+            else if (c == '\n') { i++; line++; col = 1; }
+            else if (c == '\r' && i + 1 < n && src[i + 1] == '\n') { i++; }
+            else break;
+            if (++seen == SHORT_RUN) {
+                size_t run = simd->spaceRun(src.data() + i, n - i);
+                if (run) advanceTo(i + run, true);
+                seen = 0;
+            }
         }
-        return c;
     }
 
-    //classificadores de caracteres
-    bool isIdentifierStart(char c) { return isalpha((unsigned char)c) || c == '_'; }
-    bool isIdentifierPart(char c)  { return isalnum((unsigned char)c) || c == '_'; }
-    bool isDigit(char c)           { return isdigit((unsigned char)c); }
-    bool isWhitespace(char c)      { return c == ' ' || c == '\t' || c == '\n'; }
+    // avança enquanto `in(c)` vale; depois de SHORT_RUN bytes usa o kernel
+    template <typename In>
+    size_t runWhile(size_t j, In in, size_t (*kernel)(const char*, size_t)) const {
+        size_t n = src.size();
+        size_t e = j + SHORT_RUN < n ? j + SHORT_RUN : n;
+        while (j < e && in(static_cast<unsigned char>(src[j]))) j++;
+        if (j == e && j < n) j += kernel(src.data() + j, n - j);
+        return j;
+    }
+
+    // estados com laço em si mesmos: pula a sequência inteira de uma vez
+    size_t runFrom(ScanState st, size_t j) const {
+        switch (st) {
+            case ScanState::Ident:
+                return runWhile(j, scanIsIdent, simd->identRun);
+            case ScanState::Int:
+            case ScanState::Real:
+                return runWhile(j, [](unsigned char c) { return c >= '0' && c <= '9'; }, simd->digitRun);
+            case ScanState::Str:
+                return runWhile(j, [](unsigned char c) { return c != '"' && c != '\\' && c != '\0'; }, simd->stringRun);
+            case ScanState::Comment:
+                return runWhile(j, [](unsigned char c) { return c != '\n' && c != '\0'; }, simd->lineRun);
+            default:
+                return j;
+        }
+    }
 
 public:
-    explicit Lexer(string s) : src(move(s)) {}
+    // Os tokens gerados apontam para `s`, que precisa continuar vivo. Os
+    // identificadores são internados em `syms` (ou num interner próprio).
+    explicit Lexer(string_view s, Interner* syms = nullptr) : src(s) { useSymbols(syms); }
+
+    // Começa a ler em `start`, que deve estar na linha/coluna indicadas
+    Lexer(string_view s, size_t start, int ln, int c, Interner* syms = nullptr)
+        : src(s), i(start), line(ln), col(c) { useSymbols(syms); }
+
+    // nomes dos identificadores já lidos
+    Interner& interner() const { return *symbols; }
+
+    // posição atual no buffer e linha/coluna correspondentes
+    size_t position() const { return i; }
+    int currentLine() const { return line; }
+    int currentColumn() const { return col; }
 
     // Gera a lista de tokens do código fonte
     vector<Token> tokenize() {
@@ -114,118 +614,523 @@ public:
 
     // Gera o próximo token
     Token nextToken() {
-        while (true) {
-            char c = peek();
-            if (c == '\0') return Token(TokenType::END_OF_FILE, "<EOF>", line, col);
-            if (isWhitespace(c)) { get(); continue; }
-            break;
-        }
+        skipWhitespace();
+        if (classAt(i) == CharClass::END) return Token(TokenType::END_OF_FILE, "<EOF>", line, col);
 
         int tokLine = line;
         int tokCol  = col;
-        char c = get();
-
-        // Identificadores e keywords
-        if (isIdentifierStart(c)) {
-            string lex(1, c);
-            while (isIdentifierPart(peek())) lex.push_back(get());
-            if (keywords.count(lex)) return Token(TokenType::KEYWORD, lex, tokLine, tokCol);
-            return Token(TokenType::IDENTIFIER, lex, tokLine, tokCol);
-        }
-
-        // Números (int e real)
-        if (isDigit(c)) {
-            string lex(1, c);
-            bool hasDot = false;
-            while (true) {
-                char p = peek();
-                if (p == '.' && !hasDot && isDigit(peek(1))) {
-                    hasDot = true;
-                    lex.push_back(get());
-                } else if (isDigit(p)) {
-                    lex.push_back(get());
-                } else break;
-            }
-            if (hasDot) return Token(TokenType::NUM_REAL, lex, tokLine, tokCol);
-            return Token(TokenType::NUM_INT, lex, tokLine, tokCol);
-        }
-
-        // Strings
-        if (c == '"') {
-            string lex;
-            lex.push_back(c);
-            bool closed = false;
-            while (true) {
-                char p = get();
-                if (p == '\0') break;
-                lex.push_back(p);
-                if (p == '\\') {
-                    char nxt = get();
-                    if (nxt == '\0') break;
-                    lex.push_back(nxt);
-                    continue;
-                }
-                if (p == '"') { closed = true; break; }
-            }
-            if (!closed) {
-                return Token(TokenType::UNKNOWN, lex + "(String nunca foi fechada)", tokLine, tokCol);
-            }
-            return Token(TokenType::STRING, lex, tokLine, tokCol);
+        size_t start = i;                  // início do lexema no buffer
+
+        // percorre o autômato guardando a última aceitação
+        ScanState st = ScanState::Start;
+        size_t j = start;
+        size_t acceptEnd = start;
+        TokenType acceptType = TokenType::UNKNOWN;
+        bool byText = false;
+        while (true) {
+            ScanState next = SCAN_TRANSITIONS[static_cast<size_t>(st)][static_cast<size_t>(classAt(j))];
+            if (next == ScanState::Stop) break;
+            st = next;
+            j = runFrom(st, j + 1);
+            const ScanAccept& acc = SCAN_ACCEPT[static_cast<size_t>(st)];
+            if (acc.ok) { acceptEnd = j; acceptType = acc.tipo; byText = acc.byText; }
+        }
+
+        // string não fechada: vai até o fim (um byte nulo é consumido);
+        // Token::lexema() acrescenta o aviso
+        if (st == ScanState::Str || st == ScanState::StrEsc) {
+            if (j < src.size()) j++;
+            advanceTo(j, true);
+            return Token(TokenType::UNKNOWN, src.substr(start, j - start), tokLine, tokCol);
+        }
+
+        // comentário terminado em CRLF não inclui o '\r'
+        if (acceptType == TokenType::COMMENT && src[acceptEnd - 1] == '\r' &&
+            classAt(acceptEnd) == CharClass::NEWLINE) {
+            acceptEnd--;
         }
 
-        // Comentários de linha
-        if (c == '/' && peek() == '/') {
-            string lex;
-            lex.push_back(c);
-            lex.push_back(get());
-            while (peek() != '\n' && peek() != '\0') lex.push_back(get());
-            return Token(TokenType::COMMENT, lex, tokLine, tokCol);
+        advanceTo(acceptEnd, acceptType == TokenType::STRING);
+        string_view lex = src.substr(start, acceptEnd - start);
+        if (acceptType == TokenType::IDENTIFIER) {
+            TokenType kw = keywordKind(lex);
+            if (kw != TokenType::IDENTIFIER) return Token(kw, lex, tokLine, tokCol);
+            return Token(TokenType::IDENTIFIER, lex, tokLine, tokCol, symbols->intern(lex));
         }
+        if (byText) return Token(symbolKind(lex), lex, tokLine, tokCol);
+        return Token(acceptType, lex, tokLine, tokCol);
+    }
+
+private:
+    void useSymbols(Interner* syms) {
+        if (!syms) {
+            ownSymbols = make_shared<Interner>();
+            syms = ownSymbols.get();
+        }
+        symbols = syms;
+    }
+};
+
+// Tokens em estrutura de arrays: tipo (1 byte), offset no buffer e um
+// payload (comprimento do lexema, ou id do nome para identificadores),
+// mais um índice de inícios de linha por arquivo. Linha e coluna não são
+// guardadas; saem do índice só quando um Token é materializado. Ocupa
+// 9 bytes por token contra os 32 de um Token.
+class PackedTokens {
+public:
+    PackedTokens() = default;
+
+    // Lexa `source` direto para os arrays, sem vetor de Token intermediário
+    static PackedTokens fromLexer(string_view source, Interner& symbols) {
+        PackedTokens p(source, symbols);
+        Lexer lx(source, &symbols);
+        while (true) {
+            Token t = lx.nextToken();
+            if (t.tipo == TokenType::END_OF_FILE) { p.pushEnd(lx.position()); break; }
+            p.push(t);
+        }
+        p.shrink();
+        return p;
+    }
+
+    // Compacta tokens já gerados sobre `source` (ex.: pela tokenização paralela)
+    static PackedTokens fromTokens(const vector<Token>& tokens, string_view source, Interner& symbols) {
+        PackedTokens p(source, symbols);
+        p.kinds.reserve(tokens.size());
+        p.offsets.reserve(tokens.size());
+        p.payload.reserve(tokens.size());
+        for (const Token& t : tokens) {
+            if (t.tipo == TokenType::END_OF_FILE) { p.pushEnd(p.offsetOf(t.linha, t.coluna)); break; }
+            p.push(t);
+        }
+        return p;
+    }
+
+    size_t size() const { return kinds.size(); }
+    TokenType kind(size_t k) const { return static_cast<TokenType>(kinds[k]); }
+    size_t offset(size_t k) const { return offsets[k]; }
+
+    // lexema do token k (o EOF vira "<EOF>")
+    string_view text(size_t k) const {
+        switch (kind(k)) {
+            case TokenType::END_OF_FILE: return "<EOF>";
+            case TokenType::IDENTIFIER:  return source.substr(offsets[k], symbols->name(payload[k]).size());
+            default:                     return source.substr(offsets[k], payload[k]);
+        }
+    }
+
+    // Materializa o token k; a linha vem de uma busca binária no índice
+    Token token(size_t k) const {
+        size_t line = lineIndex(offsets[k]);
+        return makeToken(k, line);
+    }
+
+    // Igual a token(k), mas começa a procurar a linha em `lineHint` (que é
+    // atualizado); percorrer os tokens em ordem custa O(1) amortizado
+    Token token(size_t k, size_t& lineHint) const {
+        uint32_t off = offsets[k];
+        if (lineHint >= lineStarts.size() || lineStarts[lineHint] > off) {
+            lineHint = lineIndex(off);
+        } else {
+            while (lineHint + 1 < lineStarts.size() && lineStarts[lineHint + 1] <= off) lineHint++;
+        }
+        return makeToken(k, lineHint);
+    }
+
+    // memória ocupada pelos arrays
+    size_t bytes() const {
+        return kinds.capacity() + (offsets.capacity() + payload.capacity() + lineStarts.capacity()) * sizeof(uint32_t);
+    }
+
+private:
+    string_view source;
+    Interner* symbols = nullptr;
+    vector<uint8_t> kinds;
+    vector<uint32_t> offsets;
+    vector<uint32_t> payload;
+    vector<uint32_t> lineStarts;           // offset do início de cada linha
+
+    PackedTokens(string_view s, Interner& syms) : source(s), symbols(&syms) {
+        if (s.size() > UINT32_MAX) throw runtime_error("Arquivo grande demais para PackedTokens");
+        lineStarts.push_back(0);
+        for (const char* p = s.data(), *e = s.data() + s.size();
+             (p = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(e - p)))) != nullptr; ) {
+            ++p;
+            lineStarts.push_back(static_cast<uint32_t>(p - s.data()));
+        }
+    }
+
+    void push(const Token& t) {
+        kinds.push_back(static_cast<uint8_t>(t.tipo));
+        offsets.push_back(static_cast<uint32_t>(t.texto.data() - source.data()));
+        payload.push_back(t.tipo == TokenType::IDENTIFIER ? t.simbolo : static_cast<uint32_t>(t.texto.size()));
+    }
+
+    void shrink() {
+        kinds.shrink_to_fit();
+        offsets.shrink_to_fit();
+        payload.shrink_to_fit();
+    }
+
+    void pushEnd(size_t pos) {
+        kinds.push_back(static_cast<uint8_t>(TokenType::END_OF_FILE));
+        offsets.push_back(static_cast<uint32_t>(pos));
+        payload.push_back(0);
+    }
+
+    // offset da posição linha/coluna (colunas contam bytes a partir do '\n')
+    size_t offsetOf(int line, int col) const {
+        return lineStarts[static_cast<size_t>(line - 1)] + static_cast<size_t>(col - 1);
+    }
+
+    // última linha (base 0) que começa em ou antes de `off`
+    size_t lineIndex(uint32_t off) const {
+        return static_cast<size_t>(upper_bound(lineStarts.begin(), lineStarts.end(), off) - lineStarts.begin()) - 1;
+    }
+
+    Token makeToken(size_t k, size_t line) const {
+        TokenType t = kind(k);
+        int col = static_cast<int>(offsets[k] - lineStarts[line]) + 1;
+        SymbolId sym = t == TokenType::IDENTIFIER ? payload[k] : NO_SYMBOL;
+        return Token(t, text(k), static_cast<int>(line) + 1, col, sym);
+    }
+};
+
+// Fonte de tokens sob demanda para o parser: um anel pequeno sobre
+// Lexer::nextToken() (ou sobre um vetor já tokenizado). Guarda só o token
+// anterior, o atual e alguns de lookahead, então a memória do front end
+// não cresce com o tamanho da entrada.
+class TokenStream {
+public:
+    explicit TokenStream(Lexer& lexer) : lexer(&lexer) { fill(); }
+    // `start`: índice do primeiro token lido (o parser incremental retoma no meio do vetor)
+    explicit TokenStream(const vector<Token>& tokens, size_t start = 0)
+        : tokens(&tokens), pos(start), fetched(start) { fill(); }
+    explicit TokenStream(const PackedTokens& packed) : packed(&packed) { fill(); }
+
+    // token atual (k = 0) ou lookahead de até RING - 2 posições
+    const Token& peek(size_t k = 0) {
+        while (fetched <= pos + k) fill();
+        return ring[(pos + k) & (RING - 1)];
+    }
+    const Token& peek() const { return ring[pos & (RING - 1)]; }
+
+    // token anterior; no início do fluxo devolve o próprio token atual
+    const Token& previous() const {
+        return ring[(pos == 0 ? pos : pos - 1) & (RING - 1)];
+    }
+
+    // consome o token atual (o EOF se repete indefinidamente)
+    void advance() {
+        pos++;
+        if (fetched <= pos) fill();
+    }
+
+    // índice absoluto do token atual
+    size_t position() const { return pos; }
 
-        // Operadores duplos
-        if ((c == '=' && peek() == '=') || (c == '!' && peek() == '=') ||
-            (c == '<' && peek() == '=') || (c == '>' && peek() == '=') ||
-            (c == '&' && peek() == '&') || (c == '|' && peek() == '|')) {
-            string lex;
-            lex.push_back(c);
-            lex.push_back(get());
-            return Token(TokenType::OPERATOR, lex, tokLine, tokCol);
+private:
+    static constexpr size_t RING = 4;      // potência de 2
+    Lexer* lexer = nullptr;
+    const vector<Token>* tokens = nullptr;
+    const PackedTokens* packed = nullptr;
+    size_t lineHint = 0;                   // cursor de linha para `packed`
+    Token ring[RING];
+    size_t pos = 0;                        // índice absoluto do token atual
+    size_t fetched = 0;                    // tokens já puxados da fonte
+
+    void fill() {
+        Token t;
+        if (lexer) {
+            t = lexer->nextToken();
+        } else if (packed && packed->size() > 0) {
+            t = packed->token(fetched < packed->size() ? fetched : packed->size() - 1, lineHint);
+        } else if (tokens && !tokens->empty()) {
+            t = (*tokens)[fetched < tokens->size() ? fetched : tokens->size() - 1];
+        } else {
+            t = Token(TokenType::END_OF_FILE, "<EOF>", 1, 1);
         }
+        ring[fetched & (RING - 1)] = t;
+        fetched++;
+    }
+};
+
+// ===== Tokenização paralela =====
 
-        // Operadores simples
-        string singleOps = "+-*/=<>%";
-        if (singleOps.find(c) != string::npos) {
-            string lex(1, c);
-            return Token(TokenType::OPERATOR, lex, tokLine, tokCol);
+// Posição do token no buffer (não vale para o EOF, cujo texto é "<EOF>")
+inline size_t tokenOffset(const Token& t, string_view source) {
+    return static_cast<size_t>(t.texto.data() - source.data());
+}
+
+// Linha/coluna logo após o token (só strings podem conter '\n')
+inline pair<int, int> tokenEndPosition(const Token& t) {
+    size_t nl = t.texto.rfind('\n');
+    if (nl == string_view::npos) return {t.linha, t.coluna + static_cast<int>(t.texto.size())};
+    int lines = static_cast<int>(count(t.texto.begin(), t.texto.end(), '\n'));
+    return {t.linha + lines, 1 + static_cast<int>(t.texto.size() - nl - 1)};
+}
+
+// Abaixo destes tamanhos não vale a pena dividir a entrada
+constexpr size_t PARALLEL_LEX_MIN_BYTES = size_t(1) << 20;
+constexpr size_t PARALLEL_LEX_MIN_CHUNK = size_t(256) << 10;
+
+// Resultado especulativo de um pedaço: tokens com linhas relativas ao
+// início do pedaço (que sempre começa logo após um '\n')
+struct LexChunk {
+    size_t begin = 0;
+    size_t end = 0;
+    vector<Token> tokens;      // tokens que começam em [begin, end)
+    Interner symbols;          // nomes do pedaço (ids locais)
+    size_t newlines = 0;       // '\n' em [begin, end)
+    bool hitEnd = false;       // o lexer do pedaço chegou ao EOF
+};
+
+// Divide a fonte em pedaços terminados em '\n', tokeniza cada um no pool e
+// costura os resultados. Um token que atravessa a fronteira (string com
+// quebra de linha) faz o início do pedaço seguinte ser relexado em
+// sequência até reencontrar um token especulativo no mesmo offset; a
+// partir daí os dois fluxos são idênticos. A saída é a mesma de
+// Lexer::tokenize(), inclusive os ids de `symbols`: os ids locais de cada
+// pedaço são traduzidos na ordem em que os tokens são emitidos.
+inline vector<Token> tokenizeParallel(string_view source, ThreadPool& pool, Interner& symbols,
+                                      size_t minChunk = PARALLEL_LEX_MIN_CHUNK) {
+    // fronteiras: logo após o primeiro '\n' depois de cada alvo
+    size_t wanted = max<size_t>(1, min(pool.size() * 4, source.size() / max<size_t>(minChunk, 1)));
+    vector<size_t> bounds = {0};
+    for (size_t c = 1; c < wanted; ++c) {
+        size_t target = source.size() / wanted * c;
+        if (target <= bounds.back()) continue;
+        size_t nl = source.find('\n', target);
+        if (nl == string_view::npos || nl + 1 >= source.size()) break;
+        if (nl + 1 > bounds.back()) bounds.push_back(nl + 1);
+    }
+    if (bounds.size() == 1) return Lexer(source, &symbols).tokenize();
+    bounds.push_back(source.size());
+
+    const ScanKernels& simd = scanKernels();
+    vector<LexChunk> chunks(bounds.size() - 1);
+    pool.parallelFor(chunks.size(), [&](size_t c) {
+        LexChunk& ch = chunks[c];
+        ch.begin = bounds[c];
+        ch.end = bounds[c + 1];
+        ch.newlines = simd.countNewlines(source.data() + ch.begin, ch.end - ch.begin);
+        ch.tokens.reserve((ch.end - ch.begin) / 4);
+        Lexer lx(source, ch.begin, 1, 1, &ch.symbols);
+        while (true) {
+            Token t = lx.nextToken();
+            if (t.tipo == TokenType::END_OF_FILE) { ch.hitEnd = true; break; }
+            if (tokenOffset(t, source) >= ch.end) break;
+            ch.tokens.push_back(t);
+        }
+    });
+
+    size_t total = 0;
+    for (const auto& ch : chunks) total += ch.tokens.size();
+    vector<Token> out;
+    out.reserve(total + 1);
+
+    // estado do lexer sequencial logo após o último token emitido
+    size_t resume = 0;
+    int resumeLine = 1, resumeCol = 1;
+    int baseLine = 1;                      // linha global do início do pedaço
+    bool prevSynced = true;                // o pedaço anterior terminou alinhado
+    auto emitFrom = [&](const Token& t) {
+        out.push_back(t);
+        resume = tokenOffset(t, source) + t.texto.size();
+        auto end = tokenEndPosition(t);
+        resumeLine = end.first;
+        resumeCol = end.second;
+    };
+
+    vector<SymbolId> remap;                // id local do pedaço -> id global
+    for (const auto& ch : chunks) {
+        int fix = baseLine - 1;
+        baseLine += static_cast<int>(ch.newlines);
+        size_t idx = 0;
+        const vector<Token>& spec = ch.tokens;
+        // se o pedaço anterior terminou alinhado e nenhum token dele invadiu
+        // este, o primeiro token especulativo já é o do lexer sequencial
+        bool synced = prevSynced && resume <= ch.begin;
+        while (!synced) {
+            while (idx < spec.size() && tokenOffset(spec[idx], source) < resume) idx++;
+            if (idx == spec.size()) break;                 // pedaço todo já consumido
+            Lexer lx(source, resume, resumeLine, resumeCol, &symbols);
+            Token t = lx.nextToken();
+            if (t.tipo == TokenType::END_OF_FILE) {
+                out.push_back(t);
+                return out;
+            }
+            size_t off = tokenOffset(t, source);
+            while (idx < spec.size() && tokenOffset(spec[idx], source) < off) idx++;
+            if (idx < spec.size() && tokenOffset(spec[idx], source) == off) {
+                synced = true;                             // mesmo offset => mesmo fluxo
+            } else {
+                emitFrom(t);
+            }
+        }
+        prevSynced = synced;
+        if (!synced) continue;
+        if (idx < spec.size()) {
+            size_t first = out.size();
+            out.insert(out.end(), spec.begin() + idx, spec.end());
+            remap.assign(ch.symbols.size(), NO_SYMBOL);
+            for (size_t k = first; k < out.size(); ++k) {
+                Token& t = out[k];
+                t.linha += fix;
+                if (t.simbolo != NO_SYMBOL) {
+                    SymbolId& g = remap[t.simbolo];
+                    if (g == NO_SYMBOL) g = symbols.intern(t.texto);
+                    t.simbolo = g;
+                }
+            }
+            Token last = out.back();
+            out.pop_back();
+            emitFrom(last);                // atualiza a posição de retomada
         }
+        if (ch.hitEnd) break;
+    }
+
+    // o que sobrou depois do último pedaço alinhado (normalmente só o EOF)
+    Lexer tail(source, resume, resumeLine, resumeCol, &symbols);
+    while (true) {
+        Token t = tail.nextToken();
+        out.push_back(t);
+        if (t.tipo == TokenType::END_OF_FILE) break;
+    }
+    return out;
+}
+
+// ===== Relexing incremental =====
+
+// Edição de texto: os bytes [inicio, inicio + removidos) da fonte antiga
+// são substituídos por `inserido`
+struct TextEdit {
+    size_t inicio;
+    size_t removidos;
+    string_view inserido;
+};
+
+// Trecho do vetor de tokens trocado por relexEdit: os tokens antigos
+// [primeiro, primeiro + removidos) viraram [primeiro, primeiro + inseridos)
+struct RelexResult {
+    size_t primeiro;
+    size_t removidos;
+    size_t inseridos;
+};
+
+// Atualiza `tokens` (gerados sobre `oldSource`) para `newSource`, que é a
+// fonte antiga com `edit` aplicado. Relexa a partir do fim do último token
+// que a edição não pode afetar até o fluxo novo voltar a começar um token
+// no mesmo ponto (deslocado) de um token antigo; os tokens seguintes são
+// reaproveitados, só com offset/linha/coluna deslocados. O custo de lexing
+// é proporcional à edição; os demais tokens só são reapontados para o
+// buffer novo. De `oldSource` só se usa o endereço base (não é lido).
+// `symbols` é o interner que gerou os tokens antigos.
+inline RelexResult relexEdit(vector<Token>& tokens, string_view oldSource,
+                             string_view newSource, const TextEdit& edit, Interner& symbols) {
+    const size_t editEnd = edit.inicio + edit.removidos;                // coords antigas
+    const size_t insEnd = edit.inicio + edit.inserido.size();           // coords novas
+    const ptrdiff_t delta = static_cast<ptrdiff_t>(edit.inserido.size()) -
+                            static_cast<ptrdiff_t>(edit.removidos);
+    auto oldOffset = [&](const Token& t) {
+        if (t.tipo == TokenType::END_OF_FILE) return oldSource.size();
+        return static_cast<size_t>(t.texto.data() - oldSource.data());
+    };
 
-        // Pontuação
-        string punct = "();,{}[]";
-        if (punct.find(c) != string::npos) {
-            string lex(1, c);
-            return Token(TokenType::PUNCTUATION, lex, tokLine, tokCol);
+    // primeiro token afetado: o scanner olha até 2 bytes após o fim do
+    // lexema (ex.: "1." + dígito), então quem termina perto da edição entra
+    size_t eof = tokens.size() - 1;
+    size_t first = static_cast<size_t>(partition_point(tokens.begin(), tokens.begin() + eof,
+        [&](const Token& t) { return oldOffset(t) + t.texto.size() + 2 <= edit.inicio; }) - tokens.begin());
+
+    // o prefixo não muda; só é reapontado se o buffer mudou de lugar
+    if (oldSource.data() != newSource.data()) {
+        for (size_t k = 0; k < first; ++k) {
+            tokens[k].texto = newSource.substr(oldOffset(tokens[k]), tokens[k].texto.size());
         }
+    }
+
+    size_t start = 0;
+    int startLine = 1, startCol = 1;
+    if (first > 0) {
+        const Token& prev = tokens[first - 1];
+        start = static_cast<size_t>(prev.texto.data() - newSource.data()) + prev.texto.size();
+        auto end = tokenEndPosition(prev);
+        startLine = end.first;
+        startCol = end.second;
+    }
 
-        // Caractere desconhecido
-        string lex(1, c);
-        return Token(TokenType::UNKNOWN, lex, tokLine, tokCol);
+    // relexa até sincronizar com um token antigo depois da edição
+    vector<Token> fresh;
+    Lexer lx(newSource, start, startLine, startCol, &symbols);
+    size_t sync = first;                   // candidato a token antigo reaproveitado
+    bool synced = false;
+    while (true) {
+        Token t = lx.nextToken();
+        if (t.tipo == TokenType::END_OF_FILE) {
+            fresh.push_back(t);
+            sync = tokens.size();
+            break;
+        }
+        size_t off = static_cast<size_t>(t.texto.data() - newSource.data());
+        if (off >= insEnd) {
+            size_t oldOff = static_cast<size_t>(static_cast<ptrdiff_t>(off) - delta);
+            while (sync < eof && oldOffset(tokens[sync]) < oldOff) sync++;
+            if (sync < eof && oldOffset(tokens[sync]) == oldOff && oldOff >= editEnd) {
+                // mesmo ponto de partida => o restante do fluxo é idêntico
+                int lineShift = t.linha - tokens[sync].linha;
+                int colShift = t.coluna - tokens[sync].coluna;
+                int syncLine = tokens[sync].linha;
+                for (size_t k = sync; k < tokens.size(); ++k) {
+                    Token& old = tokens[k];
+                    if (old.linha == syncLine) old.coluna += colShift;
+                    if (old.tipo != TokenType::END_OF_FILE) {
+                        size_t o = static_cast<size_t>(static_cast<ptrdiff_t>(oldOffset(old)) + delta);
+                        old.texto = newSource.substr(o, old.texto.size());
+                    }
+                    old.linha += lineShift;
+                }
+                synced = true;
+                break;
+            }
+        }
+        fresh.push_back(t);
     }
+
+    size_t removed = sync - first;
+    if (!synced) removed = tokens.size() - first;
+    tokens.erase(tokens.begin() + first, tokens.begin() + first + removed);
+    tokens.insert(tokens.begin() + first, fresh.begin(), fresh.end());
+    return {first, removed, fresh.size()};
+}
+
+// Tokens de um arquivo (compactados) junto com o buffer para o qual
+// apontam e os nomes dos identificadores
+struct SourceTokens {
+    shared_ptr<SourceBuffer> source;
+    shared_ptr<Interner> symbols;
+    PackedTokens tokens;
 };
 
 // Funções utilitárias para o pipeline
-// Tokeniza a fonte de uma string
-inline vector<Token> tokenizeSource(const string& source) {
-    Lexer lexer(source);
+// Tokeniza a fonte de uma string (os tokens apontam para `source`)
+inline vector<Token> tokenizeSource(string_view source, Interner* symbols = nullptr) {
+    Lexer lexer(source, symbols);
     return lexer.tokenize();
 }
 
-// Tokeniza a fonte de um arquivo
-inline vector<Token> tokenizeFile(const string& filename) {
-    ifstream file(filename);
-    if (!file) {
-        throw runtime_error("Nao foi possivel abrir: " + filename);
+// Tokeniza a fonte de um arquivo mapeado em memória; arquivos grandes são
+// divididos em pedaços tokenizados em paralelo
+inline SourceTokens tokenizeFile(const string& filename) {
+    SourceTokens out;
+    out.source = SourceBuffer::fromFile(filename);
+    out.symbols = make_shared<Interner>();
+    string_view text = out.source->text();
+    if (text.size() >= PARALLEL_LEX_MIN_BYTES && defaultThreadCount() > 1) {
+        out.tokens = PackedTokens::fromTokens(tokenizeParallel(text, defaultThreadPool(), *out.symbols),
+                                              text, *out.symbols);
+    } else {
+        out.tokens = PackedTokens::fromLexer(text, *out.symbols);
     }
-    stringstream ss;
-    ss << file.rdbuf();
-    return tokenizeSource(ss.str());
+    return out;
 }
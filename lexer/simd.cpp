@@ -0,0 +1,297 @@
+// simd.cpp
+// Compiladores - Kernels SIMD do analisador léxico
+// Varreduras de 16 (SSE2) ou 32 (AVX2) bytes por vez para os laços quentes
+// do scanner: espaços, identificadores, dígitos, fim de comentário, corpo
+// de string e contagem de '\n'. A implementação é escolhida em tempo de
+// execução; fora de x86-64 (ou sem AVX2) cai para SSE2/escalar.
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define LEXER_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define LEXER_TARGET_AVX2
+#else
+#define LEXER_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// Conjunto de kernels; cada um devolve quantos bytes a partir de `p`
+// pertencem à classe procurada (ou, para os *Run de busca, quantos bytes
+// vêm antes do próximo delimitador). Nunca leem além de p + n.
+struct ScanKernels {
+    const char* name;
+    size_t (*spaceRun)(const char* p, size_t n);    // ' ', '\t', '\n'
+    size_t (*identRun)(const char* p, size_t n);    // [A-Za-z0-9_]
+    size_t (*digitRun)(const char* p, size_t n);    // [0-9]
+    size_t (*lineRun)(const char* p, size_t n);     // até '\n' ou '\0'
+    size_t (*stringRun)(const char* p, size_t n);   // até '"', '\\' ou '\0'
+    size_t (*countNewlines)(const char* p, size_t n);
+};
+
+// ===== versão escalar =====
+
+inline bool scanIsIdent(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static size_t scalarSpaceRun(const char* p, size_t n) {
+    size_t k = 0;
+    while (k < n && (p[k] == ' ' || p[k] == '\t' || p[k] == '\n')) k++;
+    return k;
+}
+
+static size_t scalarIdentRun(const char* p, size_t n) {
+    size_t k = 0;
+    while (k < n && scanIsIdent(static_cast<unsigned char>(p[k]))) k++;
+    return k;
+}
+
+static size_t scalarDigitRun(const char* p, size_t n) {
+    size_t k = 0;
+    while (k < n && p[k] >= '0' && p[k] <= '9') k++;
+    return k;
+}
+
+static size_t scalarLineRun(const char* p, size_t n) {
+    size_t k = 0;
+    while (k < n && p[k] != '\n' && p[k] != '\0') k++;
+    return k;
+}
+
+static size_t scalarStringRun(const char* p, size_t n) {
+    size_t k = 0;
+    while (k < n && p[k] != '"' && p[k] != '\\' && p[k] != '\0') k++;
+    return k;
+}
+
+static size_t scalarCountNewlines(const char* p, size_t n) {
+    size_t count = 0;
+    const char* e = p + n;
+    while ((p = static_cast<const char*>(memchr(p, '\n', e - p))) != nullptr) {
+        count++;
+        p++;
+    }
+    return count;
+}
+
+#ifdef LEXER_SIMD_X86
+
+inline unsigned scanCtz(uint32_t m) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long idx;
+    _BitScanForward(&idx, m);
+    return static_cast<unsigned>(idx);
+#else
+    return static_cast<unsigned>(__builtin_ctz(m));
+#endif
+}
+
+inline unsigned scanPopcount(uint32_t m) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    m = m - ((m >> 1) & 0x55555555u);
+    m = (m & 0x33333333u) + ((m >> 2) & 0x33333333u);
+    return (((m + (m >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+#else
+    return static_cast<unsigned>(__builtin_popcount(m));
+#endif
+}
+
+// ===== SSE2 (16 bytes) =====
+
+// bytes de v em [lo, hi] (comparação sem sinal via deslocamento de 0x80)
+static inline __m128i sse2InRange(__m128i v, char lo, char hi) {
+    __m128i t = _mm_add_epi8(_mm_sub_epi8(v, _mm_set1_epi8(lo)), _mm_set1_epi8(static_cast<char>(-128)));
+    return _mm_cmplt_epi8(t, _mm_set1_epi8(static_cast<char>(hi - lo + 1 - 128)));
+}
+
+static inline __m128i sse2Ident(__m128i v) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i m = sse2InRange(lower, 'a', 'z');
+    m = _mm_or_si128(m, sse2InRange(v, '0', '9'));
+    return _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+}
+
+static inline __m128i sse2Space(__m128i v) {
+    __m128i m = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+    m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+    return _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+}
+
+static inline __m128i sse2LineStop(__m128i v) {
+    return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_setzero_si128()));
+}
+
+static inline __m128i sse2StringStop(__m128i v) {
+    __m128i m = _mm_cmpeq_epi8(v, _mm_set1_epi8('"'));
+    m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+    return _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_setzero_si128()));
+}
+
+// percorre blocos enquanto todos os bytes pertencem à classe (run = true)
+// ou enquanto nenhum byte é delimitador (run = false)
+template <bool RUN, typename Classify, typename Tail>
+static inline size_t sse2Scan(const char* p, size_t n, Classify classify, Tail tail) {
+    size_t k = 0;
+    for (; k + 16 <= n; k += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + k));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(classify(v)));
+        if (RUN) mask = ~mask & 0xFFFFu;
+        if (mask) return k + scanCtz(mask);
+    }
+    return k + tail(p + k, n - k);
+}
+
+static size_t sse2SpaceRun(const char* p, size_t n)  { return sse2Scan<true>(p, n, sse2Space, scalarSpaceRun); }
+static size_t sse2IdentRun(const char* p, size_t n)  { return sse2Scan<true>(p, n, sse2Ident, scalarIdentRun); }
+static size_t sse2DigitRun(const char* p, size_t n) {
+    return sse2Scan<true>(p, n, [](__m128i v) { return sse2InRange(v, '0', '9'); }, scalarDigitRun);
+}
+static size_t sse2LineRun(const char* p, size_t n)   { return sse2Scan<false>(p, n, sse2LineStop, scalarLineRun); }
+static size_t sse2StringRun(const char* p, size_t n) { return sse2Scan<false>(p, n, sse2StringStop, scalarStringRun); }
+
+static size_t sse2CountNewlines(const char* p, size_t n) {
+    size_t count = 0, k = 0;
+    const __m128i nl = _mm_set1_epi8('\n');
+    for (; k + 16 <= n; k += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + k));
+        count += scanPopcount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl))));
+    }
+    return count + scalarCountNewlines(p + k, n - k);
+}
+
+// ===== AVX2 (32 bytes) =====
+
+LEXER_TARGET_AVX2 static inline __m256i avx2InRange(__m256i v, char lo, char hi) {
+    __m256i t = _mm256_add_epi8(_mm256_sub_epi8(v, _mm256_set1_epi8(lo)), _mm256_set1_epi8(static_cast<char>(-128)));
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi - lo + 1 - 128)), t);
+}
+
+LEXER_TARGET_AVX2 static inline uint32_t avx2IdentMask(const char* p) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i m = avx2InRange(lower, 'a', 'z');
+    m = _mm256_or_si256(m, avx2InRange(v, '0', '9'));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(m));
+}
+
+LEXER_TARGET_AVX2 static inline uint32_t avx2SpaceMask(const char* p) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i m = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(m));
+}
+
+LEXER_TARGET_AVX2 static inline uint32_t avx2DigitMask(const char* p) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(avx2InRange(v, '0', '9')));
+}
+
+LEXER_TARGET_AVX2 static inline uint32_t avx2LineStopMask(const char* p) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+                                _mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(m));
+}
+
+LEXER_TARGET_AVX2 static inline uint32_t avx2StringStopMask(const char* p) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i m = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(m));
+}
+
+// blocos de 32 bytes; o resto vai para a versão SSE2
+#define LEXER_AVX2_SCAN(NAME, MASK, RUN, TAIL)                      \
+    LEXER_TARGET_AVX2 static size_t NAME(const char* p, size_t n) { \
+        size_t k = 0;                                                \
+        for (; k + 32 <= n; k += 32) {                               \
+            uint32_t mask = MASK(p + k);                             \
+            if (RUN) mask = ~mask;                                   \
+            if (mask) return k + scanCtz(mask);                      \
+        }                                                            \
+        return k + TAIL(p + k, n - k);                               \
+    }
+
+LEXER_AVX2_SCAN(avx2SpaceRun, avx2SpaceMask, true, sse2SpaceRun)
+LEXER_AVX2_SCAN(avx2IdentRun, avx2IdentMask, true, sse2IdentRun)
+LEXER_AVX2_SCAN(avx2DigitRun, avx2DigitMask, true, sse2DigitRun)
+LEXER_AVX2_SCAN(avx2LineRun, avx2LineStopMask, false, sse2LineRun)
+LEXER_AVX2_SCAN(avx2StringRun, avx2StringStopMask, false, sse2StringRun)
+#undef LEXER_AVX2_SCAN
+
+LEXER_TARGET_AVX2 static size_t avx2CountNewlines(const char* p, size_t n) {
+    size_t count = 0, k = 0;
+    const __m256i nl = _mm256_set1_epi8('\n');
+    for (; k + 32 <= n; k += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + k));
+        count += scanPopcount(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl))));
+    }
+    return count + sse2CountNewlines(p + k, n - k);
+}
+
+// CPU e sistema operacional suportam AVX2?
+static bool cpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;   // estados XMM e YMM habilitados
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // LEXER_SIMD_X86
+
+static const ScanKernels SCALAR_KERNELS = {
+    "scalar", scalarSpaceRun, scalarIdentRun, scalarDigitRun,
+    scalarLineRun, scalarStringRun, scalarCountNewlines
+};
+
+#ifdef LEXER_SIMD_X86
+static const ScanKernels SSE2_KERNELS = {
+    "sse2", sse2SpaceRun, sse2IdentRun, sse2DigitRun,
+    sse2LineRun, sse2StringRun, sse2CountNewlines
+};
+
+static const ScanKernels AVX2_KERNELS = {
+    "avx2", avx2SpaceRun, avx2IdentRun, avx2DigitRun,
+    avx2LineRun, avx2StringRun, avx2CountNewlines
+};
+#endif
+
+// Escolhe os kernels uma vez por processo. MICROCOMPILADOR_SIMD=scalar|sse2|avx2
+// força uma implementação (útil para comparar saídas e medir).
+static const ScanKernels& detectScanKernels() {
+    const char* env = std::getenv("MICROCOMPILADOR_SIMD");
+    std::string forced = env ? env : "";
+    if (forced == "scalar") return SCALAR_KERNELS;
+#ifdef LEXER_SIMD_X86
+    if (forced == "sse2") return SSE2_KERNELS;
+    if (cpuHasAvx2()) return AVX2_KERNELS;
+    return SSE2_KERNELS;
+#else
+    return SCALAR_KERNELS;
+#endif
+}
+
+inline const ScanKernels& scanKernels() {
+    static const ScanKernels& k = detectScanKernels();
+    return k;
+}
@@ -1,9 +1,17 @@
 // main.cpp - CLI para lexer, parser (AST), semântica e execução
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <vector>
 #include "../semantic/semantic.cpp"
 #include "../exec/exec.cpp"
+#include "../opt/slots.cpp"
+#include "../opt/fold.cpp"
+#include "../opt/cse.cpp"
+#include "../opt/passes.cpp"
+#include "../semantic/cache.cpp"        // depende de analyzeSource e das otimizações
+#include "../ir/ir.cpp"
+#include "../ir/dataflow.cpp"
 
 using namespace std;
 
@@ -13,12 +21,50 @@ static void printUsage(const string& prog) {
     cerr << "  " << prog << " --tokens <arquivo>\n";
     cerr << "  " << prog << " --ast    <arquivo>\n";
     cerr << "  " << prog << " --run    <arquivo>\n";
+    cerr << "  " << prog << " --ir     <arquivo>\n";
+    cerr << "  " << prog << " --check  <arquivo>...\n";
+    cerr << "  " << prog << " --emit-ast-bin <saida> <arquivo>\n";
+    cerr << "  " << prog << " --edit   <arquivo> <roteiro>\n";
+    cerr << "  (--ast, --run e --ir também aceitam uma imagem gerada por --emit-ast-bin)\n";
+    cerr << "Opcoes:\n";
+    cerr << "  --cache-dir <dir>   cache da AST checada (ou MICROCOMPILADOR_CACHE)\n";
+    cerr << "  -O0 | -O1 | -O2     nivel de otimizacao (padrao: -O1 no --run, -O0 nos demais)\n";
+    cerr << "  --passes <lista>    passes na ordem dada, no lugar dos do nivel (ex.: cse ou fold,cse)\n";
+    cerr << "  --pass-stats        tempo, nos e reescritas de cada passe (em stderr)\n";
 }
 
-// Impressão simples da AST
-static void printAst(const shared_ptr<ASTNode>& node, int indent = 0) {
-    if (!node) return;                              // nó nulo
-    for (int i = 0; i < indent; ++i) cout << "  ";  // indentação
+// Imprime os erros semânticos em stderr, um por linha com a posição
+static void printSemanticErrors(const vector<SemanticError>& errors) {
+    for (const auto& e : errors) {
+        cerr << "[Erro semantico] " << e.message
+             << " (" << e.linha << "," << e.coluna << ")\n";
+    }
+}
+
+// Valida um arquivo sem parar no primeiro erro: imprime todos os erros
+// sintáticos (e, se não houver nenhum, os semânticos) e devolve quantos foram
+static size_t checkFile(const string& filename) {
+    auto source = SourceBuffer::fromFile(filename);
+    Lexer lexer(source->text());
+    Parser parser(lexer);
+    ParseResult parsed = parser.parseWithRecovery();
+    for (const auto& e : parsed.errors) {
+        cerr << "[Erro sintatico] " << e.message
+             << " (" << e.linha << "," << e.coluna << ")\n";
+    }
+    if (!parsed.errors.empty()) return parsed.errors.size();   // AST parcial: a semântica só geraria ruído
+
+    // arquivos grandes: expressões checadas em paralelo (mesmos erros)
+    auto sem = useParallelParse(source->text()) ? checkProgramParallel(parsed.ast, defaultThreadPool())
+                                                : checkProgram(parsed.ast);
+    printSemanticErrors(sem.errors);
+    return sem.errors.size();
+}
+
+// Impressão simples da AST (pré-ordem com pilha explícita, para não
+// depender da profundidade da árvore)
+static void printAst(const AstPool& ast, NodeId root, ostream& out = cout) {
+    if (root == NO_NODE) return;                    // nó nulo
 
     // converte NodeKind para string
     auto kindToStr = [](NodeKind k) {
@@ -31,21 +77,179 @@ static void printAst(const shared_ptr<ASTNode>& node, int indent = 0) {
             case NodeKind::Binary:     return "Binary";
             case NodeKind::Literal:    return "Literal";
             case NodeKind::Identifier: return "Identifier";
+            case NodeKind::Promote:    return "Promote";
+            case NodeKind::Temp:       return "Temp";
         }
         return "Node";
     };
 
-    // imprime nó
-    cout << kindToStr(node->kind) << " : \"" << node->value << "\""
-         << " [" << node->token.linha << "," << node->token.coluna << "]\n";
-    for (const auto& child : node->children) {  // filhos
-        printAst(child, indent + 1);
+    vector<pair<NodeId, int>> work = {{root, 0}};   // (nó, indentação)
+    while (!work.empty()) {
+        auto [node, indent] = work.back();
+        work.pop_back();
+        if (ast.kind(node) == NodeKind::Promote) {      // implícito: imprime o operando
+            work.push_back({ast.child(node, 0), indent});
+            continue;
+        }
+        for (int i = 0; i < indent; ++i) out << "  ";   // indentação
+
+        // imprime nó
+        const Token& tok = ast.token(node);
+        out << kindToStr(ast.kind(node)) << " : \"" << ast.value(node) << "\""
+             << " [" << tok.linha << "," << tok.coluna << "]\n";
+        for (size_t i = ast.childCount(node); i-- > 0;) {  // filhos (o primeiro sai antes)
+            work.push_back({ast.child(node, i), indent + 1});
+        }
+    }
+}
+
+// Offset de (linha, coluna) no texto, contados a partir de 1 como nos tokens
+static size_t offsetAt(string_view text, int linha, int coluna) {
+    if (linha < 1 || coluna < 1) throw runtime_error("Edicao fora do texto");
+    size_t off = 0;
+    for (int l = 1; l < linha; ++l) {
+        off = text.find('\n', off);
+        if (off == string_view::npos) throw runtime_error("Edicao fora do texto");
+        ++off;
+    }
+    return off + static_cast<size_t>(coluna - 1);
+}
+
+// Aplica o roteiro de edições `scriptName` a `filename` com o
+// IncrementalParser (que relexa cada edição com relexEdit) e imprime, depois
+// de cada uma, quantos statements foram reparseados e a AST. Cada linha do
+// roteiro é `linha coluna removidos texto`, com \n e \\ no texto; linhas
+// vazias ou começadas por // são ignoradas. Cada árvore é conferida contra
+// um parse completo do mesmo texto; devolve 1 se alguma diferir.
+static int editFile(const string& filename, const string& scriptName) {
+    auto source = SourceBuffer::fromFile(filename);
+    auto script = SourceBuffer::fromFile(scriptName);
+    IncrementalParser inc{string(source->text())};
+
+    bool mismatch = false;
+    auto show = [&]() {
+        ostringstream got, want;
+        printAst(inc.tree(), inc.tree().root, got);
+        vector<Token> tokens = tokenizeSource(inc.text());
+        Parser parser(tokens);
+        AstPool full = parser.parse();
+        printAst(full, full.root, want);
+        cout << got.str();
+        if (got.str() != want.str()) {
+            cout << "[Erro] AST incremental difere do parse completo\n";
+            mismatch = true;
+        }
+    };
+    cout << "== original: " << inc.lastReparsed() << " statement(s) parseado(s)\n";
+    show();
+
+    istringstream lines{string(script->text())};
+    string line;
+    size_t count = 0;
+    while (getline(lines, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line.rfind("//", 0) == 0) continue;
+        istringstream fields(line);
+        int linha = 0, coluna = 0;
+        size_t removidos = 0;
+        if (!(fields >> linha >> coluna >> removidos)) throw runtime_error("Linha invalida no roteiro: " + line);
+        string raw;
+        if (fields.get() == ' ') getline(fields, raw);
+        string inserido;
+        for (size_t k = 0; k < raw.size(); ++k) {
+            if (raw[k] == '\\' && k + 1 < raw.size()) {
+                ++k;
+                inserido += raw[k] == 'n' ? '\n' : raw[k];
+            } else {
+                inserido += raw[k];
+            }
+        }
+
+        cout << "== edicao " << ++count << ": (" << linha << "," << coluna << ") -" << removidos
+             << " +\"" << raw << "\"\n";
+        try {
+            inc.edit(TextEdit{offsetAt(inc.text(), linha, coluna), removidos, inserido});
+        } catch (const exception& e) {          // erro sintático: a próxima edição reparseia tudo
+            cout << e.what() << "\n";
+            continue;
+        }
+        cout << inc.lastReparsed() << " statement(s) reparseado(s)\n";
+        show();
+    }
+    return mismatch ? 1 : 0;
+}
+
+// Imprime o IR em SSA bloco a bloco, com os predecessores, os valores vivos
+// e as escritas de variáveis que alcançam a entrada de cada bloco, e quantas
+// vezes cada valor é usado
+static void printIr(const IrFunction& fn) {
+    Liveness live = computeLiveness(fn);
+    ReachingDefs reach = computeReachingDefs(fn);
+    UseDefChains uses(fn);
+    for (BlockId b = 0; b < fn.blocks.size(); ++b) {
+        cout << "b" << b << ":";
+        string sep = "  ; ";                        // anotações do bloco, separadas por "; "
+        const vector<BlockId>& preds = fn.blocks[b].preds;
+        if (!preds.empty()) {
+            cout << sep << "preds";
+            for (BlockId p : preds) cout << " b" << p;
+            sep = "; ";
+        }
+        bool first = true;
+        live.liveIn[b].forEach([&](size_t v) {
+            cout << (first ? sep + "vivos" : "") << " %" << v;
+            first = false;
+        });
+        if (!first) sep = "; ";
+        first = true;
+        reach.in[b].forEach([&](size_t w) {     // escritas de variáveis que chegam ao bloco
+            cout << (first ? sep + "alcancam" : "") << " " << fn.vars[fn.writes[w].var].name << "=%" << fn.writes[w].value;
+            first = false;
+        });
+        cout << "\n";
+        for (ValueId id : fn.blocks[b].insts) {
+            cout << "  ";
+            printIrInst(cout, fn, id);
+            if (!fn.isTerminator(id)) cout << (fn.insts[id].var != NO_VAR ? "; " : "  ; ") << "usos " << uses.useCount(id);
+            cout << "\n";
+        }
     }
 }
 
 // Função principal
 int main(int argc, char** argv) {
-    if (argc != 3) {                // espera 2 argumentos  
+    // --cache-dir, -O<n>, --passes e --pass-stats valem em qualquer posição
+    // e saem da lista de argumentos
+    string cacheDir = FrontEndCache::defaultDirectory();
+    int optArg = -1;                // -1: padrão do modo
+    string passList;                // vazio: passes do nível
+    bool passStats = false;
+    vector<char*> args;
+    for (int k = 0; k < argc; ++k) {
+        string arg = argv[k];
+        if (arg == "--cache-dir" && k + 1 < argc) {
+            cacheDir = argv[++k];
+            continue;
+        }
+        if (arg.size() == 3 && arg[0] == '-' && arg[1] == 'O' && arg[2] >= '0' &&
+            arg[2] <= static_cast<char>('0' + PassManager::MAX_LEVEL)) {
+            optArg = arg[2] - '0';
+            continue;
+        }
+        if (arg == "--passes" && k + 1 < argc) {
+            passList = argv[++k];
+            continue;
+        }
+        if (arg == "--pass-stats") {
+            passStats = true;
+            continue;
+        }
+        args.push_back(argv[k]);
+    }
+    argc = static_cast<int>(args.size());
+    argv = args.data();
+
+    if (argc < 3) {                 // espera modo e arquivo
         printUsage(argv[0]);    
         return 1;
     }
@@ -53,48 +257,137 @@ int main(int argc, char** argv) {
     string mode = argv[1];          // modo de operação
     string filename = argv[2];      // arquivo de entrada
 
+    // modo de validação em lote: vários arquivos, todos os erros de cada um
+    if (mode == "--check") {
+        bool failed = false;
+        for (int k = 2; k < argc; ++k) {
+            try {
+                size_t errors = checkFile(argv[k]);
+                cout << argv[k] << ": ";
+                if (errors == 0) cout << "ok\n";
+                else cout << errors << " erro(s)\n";
+                failed = failed || errors > 0;
+            } catch (const exception& e) {          // arquivo ilegível
+                cerr << "Erro: " << e.what() << "\n";
+                failed = true;
+            }
+        }
+        return failed ? 1 : 0;
+    }
+
+    // grava a AST checada como imagem binária (ver parser/astbin.cpp)
+    if (mode == "--emit-ast-bin") {
+        if (argc != 4) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        try {
+            auto source = SourceBuffer::fromFile(argv[3]);
+            Interner symbols;
+            FrontEndResult front = analyzeSource(source->text(), symbols);
+            vector<PassStats> stats;
+            if (!front.sem.errors.empty()) {    // só programas válidos viram imagem
+                printSemanticErrors(front.sem.errors);
+                return 1;
+            }
+            // sem -O nem --passes a imagem guarda a AST checada, como o --ast a mostra
+            AstBinKey key;
+            key.optLevel = optArg > 0 ? static_cast<unsigned>(optArg) : 0;
+            PassManager passes = passList.empty() ? PassManager::forLevel(static_cast<unsigned>(key.optLevel))
+                                                  : PassManager::fromList(passList);
+            optimizeFrontEnd(front, passes, passStats ? &stats : nullptr);
+            if (passStats) printPassStats(stats);
+            writeAstBinary(argv[2], serializeFrontEnd(front, symbols, key));
+            return 0;
+        } catch (const exception& e) {
+            cerr << "Erro: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    // reparse incremental: roteiro de edições sobre o arquivo
+    if (mode == "--edit") {
+        if (argc != 4) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        try {
+            return editFile(argv[2], argv[3]);
+        } catch (const exception& e) {
+            cerr << "Erro: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    if (argc != 3) {                // demais modos: um arquivo
+        printUsage(argv[0]);
+        return 1;
+    }
+
     try {
         // modo de tokens 
         if (mode == "--tokens") {
-            auto tokens = tokenizeFile(filename);   
-            for (const auto& t : tokens) {
-                cout << t.toString() << "\n";
+            auto src = tokenizeFile(filename);      // paralelo em arquivos grandes
+            size_t lineHint = 0;
+            for (size_t k = 0; k < src.tokens.size(); ++k) {
+                cout << src.tokens.token(k, lineHint).toString() << "\n";
             }
             return 0;
         }
 
+        if (mode != "--ast" && mode != "--run" && mode != "--ir") {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        // imagem binária (--emit-ast-bin), entrada do cache ou fonte (parse +
+        // semântica); imagens são usadas direto do mapeamento. Por padrão o
+        // --run executa a AST otimizada (-O1) e o --ast mostra a checada (-O0).
+        unique_ptr<FrontEndCache> cache;
+        if (!cacheDir.empty()) cache = make_unique<FrontEndCache>(cacheDir);
+        unsigned optLevel = optArg >= 0 ? static_cast<unsigned>(optArg) : (mode == "--run" ? 1 : 0);
+        vector<PassStats> stats;
+        PassManager custom;             // lista de --passes
+        if (!passList.empty()) custom = PassManager::fromList(passList);
+        LoadedProgram program = loadProgram(filename, cache.get(), optLevel, passStats ? &stats : nullptr,
+                                            passList.empty() ? nullptr : &custom);   // vivo até o fim
+        if (passStats) printPassStats(stats);
+        if (passStats && program.fromImage) cerr << "[passe] nenhum: a AST veio de uma imagem (passes de quando foi gravada)\n";
+        const AstPool& ast = program.front.ast;
+        const SemanticResult& sem = program.front.sem;
+
         // modo de AST
         if (mode == "--ast") {
-            auto tokens = tokenizeFile(filename);
-            Parser parser(tokens);
-            auto ast = parser.parse();
-            printAst(ast);
-            auto sem = checkProgram(ast);
-            for (const auto& e : sem.errors) {
-                std::cerr << "[Erro semantico] " << e.message
-                          << " (" << e.linha << "," << e.coluna << ")\n";
+            printAst(ast, ast.root);
+            printSemanticErrors(sem.errors);
+            return 0;
+        }
+
+        // IR em SSA (só de programas sem erros, como a execução)
+        if (mode == "--ir") {
+            if (!sem.errors.empty()) {
+                printSemanticErrors(sem.errors);
+                return 1;
             }
+            printIr(buildIr(ast));
             return 0;
         }
 
         // modo de execução
         if (mode == "--run") {
-            auto tokens = tokenizeFile(filename);
-            Parser parser(tokens);
-            auto ast = parser.parse();
-            auto sem = checkProgram(ast);
             if (!sem.errors.empty()) {
-                for (const auto& e : sem.errors) {
-                    std::cerr << "[Erro semantico] " << e.message
-                              << " (" << e.linha << "," << e.coluna << ")\n";
-                }
+                printSemanticErrors(sem.errors);
                 return 1;
             }
-            std::unordered_map<std::string, RuntimeValue> values;
-            runProgram(ast, sem.symbols, values);
-            // Opcional: imprimir estado final
-            for (const auto& [name, val] : values) {
-                std::cout << name << " = ";
+            RuntimeEnv env;
+            runProgram(ast, env);
+            // Opcional: imprimir estado final (variáveis do programa, na
+            // ordem de declaração)
+            for (uint32_t slot = 0; slot < sem.symbols.globals.size(); ++slot) {
+                const RuntimeValue* v = env.get(0, slot);
+                if (!v) continue;
+                const RuntimeValue& val = *v;
+                std::cout << program.name(sem.symbols.globals[slot]) << " = ";
                 switch (val.type) {
                     case TypeKind::INT: std::cout << val.i; break;
                     case TypeKind::REAL: std::cout << val.d; break;
@@ -0,0 +1,278 @@
+// cse.cpp
+// Compiladores - Eliminação de subexpressões comuns por numeração de
+// valores. Cada expressão pura (Binary e Promote sobre identificadores e
+// literais) recebe um número pela operação e pelos números dos operandos;
+// uma expressão já calculada no mesmo caminho de execução é lida de um
+// temporário gravado pela primeira ocorrência (nó Temp) em vez de ser
+// avaliada de novo.
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Operação comutativa: operandos trocados têm o mesmo número
+static bool commutative(ExecOp op) {
+    switch (op) {
+        case ExecOp::AddInt: case ExecOp::MulInt: case ExecOp::AddReal: case ExecOp::MulReal:
+        case ExecOp::EqInt:  case ExecOp::NeInt:  case ExecOp::EqReal:  case ExecOp::NeReal:
+        case ExecOp::And:    case ExecOp::Or:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Passada de otimização: numera as expressões na ordem de execução e depois
+// troca as repetidas por leituras de temporários
+class ValueNumbering {
+public:
+    explicit ValueNumbering(AstPool& a) : ast(a) {}
+
+    size_t rewrites = 0;                   // Temp criados e expressões trocadas
+
+    void run() {
+        if (ast.root == NO_NODE) return;
+        scopes.push_back(ast.root);
+        env.pushFrame(ast.frameSize(ast.root));
+        statements(ast.root);
+        rewrite();
+    }
+
+private:
+    // Ocorrência de expressão: filho k de `parent`
+    struct Occurrence {
+        NodeId parent;
+        uint32_t k;
+    };
+
+    // Expressão numerada: onde foi calculada primeiro e em que escopo o
+    // temporário dela ficaria
+    struct Expr {
+        Occurrence first;
+        NodeId scope;                      // Program/Block da primeira ocorrência
+        uint16_t depth;
+        uint32_t reuses = 0;
+    };
+
+    // Chave de hash-consing: operação e números dos operandos
+    struct Key {
+        uint32_t op, a, b;
+        bool operator==(const Key& o) const { return op == o.op && a == o.a && b == o.b; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            uint64_t h = (static_cast<uint64_t>(k.a) << 32 | k.b) * 0x9E3779B97F4A7C15ull;
+            return static_cast<size_t>(h ^ (h >> 29) ^ k.op);
+        }
+    };
+    static constexpr uint32_t PROMOTE_OP = 0x100;       // fora dos valores de ExecOp
+    static constexpr uint32_t LITERAL_OP = 0x200;       // + tipo do literal
+    static constexpr uint32_t NO_EXPR = UINT32_MAX;
+
+    // Pilha de numberExpr: nó, posição dele no pai e, depois de expandido,
+    // onde começavam os reusos registrados dentro dele
+    struct Work {
+        NodeId node, parent;
+        uint32_t k;
+        bool expanded;
+        size_t usesBase;
+    };
+
+    AstPool& ast;
+    SlotEnv<uint32_t> env;                 // número atual de cada variável (0 = nenhum)
+    uint32_t nextVn = 1;
+    std::unordered_map<Key, uint32_t, KeyHash> table;   // expressões disponíveis
+    std::unordered_map<Key, uint32_t, KeyHash> literals;
+    std::vector<Key> added;                // entradas da tabela, para desfazer por escopo
+    std::vector<uint32_t> exprOf;          // número -> índice em exprs (NO_EXPR em folhas)
+    std::vector<Expr> exprs;
+    std::vector<std::pair<uint32_t, Occurrence>> uses;  // (expressão, ocorrência repetida)
+    std::vector<NodeId> scopes;            // Program/Block abertos
+    std::vector<Work> work;
+    std::vector<uint32_t> vns;
+    size_t temps = 0;
+
+    uint32_t fresh() {
+        exprOf.push_back(NO_EXPR);
+        return nextVn++;
+    }
+
+    uint32_t variable(NodeId id) {
+        uint32_t vn = env.get(ast.depth(id), ast.slot(id));
+        if (vn == 0) {                         // lida antes de qualquer escrita vista
+            vn = fresh();
+            env.set(ast.depth(id), ast.slot(id), vn);
+        }
+        return vn;
+    }
+
+    uint32_t literal(NodeId id) {
+        LiteralValue v = ast.literal(id);
+        if (v.outOfRange || v.type == TypeKind::STRING) return fresh();
+        uint64_t bits = static_cast<uint64_t>(v.i);
+        if (v.type == TypeKind::REAL) std::memcpy(&bits, &v.d, sizeof(bits));
+        if (v.type == TypeKind::BOOL) bits = v.b;
+        Key key{LITERAL_OP + static_cast<uint32_t>(v.type), static_cast<uint32_t>(bits >> 32), static_cast<uint32_t>(bits)};
+        auto it = literals.find(key);
+        if (it != literals.end()) return it->second;
+        return literals[key] = fresh();
+    }
+
+    // Número da expressão `key` na ocorrência `at`: reaproveita uma entrada
+    // disponível ou cria outra no escopo atual
+    uint32_t lookup(const Key& key, const Occurrence& at) {
+        auto it = table.find(key);
+        if (it != table.end()) {
+            uses.push_back({exprOf[it->second - 1], at});
+            return it->second;
+        }
+        uint32_t vn = fresh();
+        exprOf[vn - 1] = static_cast<uint32_t>(exprs.size());
+        exprs.push_back({at, scopes.back(), env.depth()});
+        table.emplace(key, vn);
+        added.push_back(key);
+        return vn;
+    }
+
+    // Numera a expressão do filho k de `parent` (pós-ordem com pilhas
+    // explícitas, operandos da esquerda para a direita como no executor)
+    uint32_t numberExpr(NodeId parent, size_t k) {
+        size_t workBase = work.size();
+        size_t vnBase = vns.size();
+        work.push_back({ast.child(parent, k), parent, static_cast<uint32_t>(k), false, 0});
+        while (work.size() > workBase) {
+            Work w = work.back();
+            work.pop_back();
+            NodeKind kind = ast.kind(w.node);
+            if (kind == NodeKind::Literal) {
+                vns.push_back(literal(w.node));
+            } else if (kind == NodeKind::Identifier) {
+                vns.push_back(variable(w.node));
+            } else if (!w.expanded) {
+                w.expanded = true;
+                w.usesBase = uses.size();
+                work.push_back(w);
+                for (size_t i = ast.childCount(w.node); i-- > 0;) {
+                    work.push_back({ast.child(w.node, i), w.node, static_cast<uint32_t>(i), false, 0});
+                }
+            } else if (kind == NodeKind::Binary || kind == NodeKind::Promote) {
+                Key key{PROMOTE_OP, vns.back(), 0};
+                if (kind == NodeKind::Binary) {
+                    uint32_t right = vns.back();
+                    vns.pop_back();
+                    key = {static_cast<uint32_t>(ast.exec(w.node)), vns.back(), right};
+                    if (commutative(ast.exec(w.node)) && key.a > key.b) std::swap(key.a, key.b);
+                }
+                size_t before = uses.size();
+                vns.back() = lookup(key, {w.parent, w.k});
+                // Binary repetido inteiro: os reusos de dentro dele somem com ele
+                if (kind == NodeKind::Binary && uses.size() > before) uses.erase(uses.begin() + static_cast<ptrdiff_t>(w.usesBase), uses.end() - 1);
+            } else {                               // Temp de outra passada: opaco
+                vns.back() = fresh();
+            }
+        }
+        uint32_t vn = vns.back();
+        vns.resize(vnBase);
+        return vn;
+    }
+
+    // Entradas criadas desde `m` deixam de estar disponíveis
+    void dropSince(size_t m) {
+        for (size_t i = m; i < added.size(); ++i) table.erase(added[i]);
+        added.resize(m);
+    }
+
+    void statements(NodeId node) {
+        for (size_t i = 0; i < ast.childCount(node); ++i) statement(ast.child(node, i));
+    }
+
+    void statement(NodeId node) {
+        switch (ast.kind(node)) {
+            case NodeKind::Block: {
+                size_t m = added.size();
+                scopes.push_back(node);
+                env.pushFrame(ast.frameSize(node));
+                statements(node);
+                env.popFrame();
+                scopes.pop_back();
+                dropSince(m);
+                break;
+            }
+
+            // a variável passa a ter o número do valor escrito
+            case NodeKind::Decl: {
+                NodeId var = ast.child(node, 0);
+                uint32_t vn = ast.childCount(node) > 1 ? numberExpr(node, 1) : fresh();
+                env.set(ast.depth(var), ast.slot(var), vn);
+                break;
+            }
+
+            case NodeKind::Assign: {
+                NodeId var = ast.child(node, 0);
+                env.set(ast.depth(var), ast.slot(var), numberExpr(node, 1));
+                break;
+            }
+
+            case NodeKind::If:
+                ifStatement(node);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    // Cada ramo vê só o que foi calculado antes do if; depois dele, toda
+    // variável escrita em algum ramo ganha um número novo
+    void ifStatement(NodeId node) {
+        numberExpr(node, 0);
+        SlotEnv<uint32_t>::Writes written;
+        for (size_t k = 1; k < ast.childCount(node); ++k) {
+            size_t m = added.size();
+            size_t mark = env.mark();
+            statement(ast.child(node, k));
+            for (const auto& w : env.writesSince(mark, env.depth())) written.insert(w);
+            env.undo(mark);
+            dropSince(m);
+        }
+        for (const auto& w : written) env.set(static_cast<uint16_t>(w.first >> 32), static_cast<uint32_t>(w.first), fresh());
+    }
+
+    // Segunda fase: a primeira ocorrência de cada Binary repetido vira
+    // Temp num slot novo do escopo dela e as repetições viram leituras
+    void rewrite() {
+        std::vector<uint32_t> slotOf(exprs.size(), NO_EXPR);
+        std::vector<uint32_t> tokenOf(exprs.size());
+        for (const auto& u : uses) ++exprs[u.first].reuses;
+        for (size_t e = 0; e < exprs.size(); ++e) {
+            const Expr& x = exprs[e];
+            NodeId first = ast.child(x.first.parent, x.first.k);
+            if (x.reuses == 0 || ast.kind(first) != NodeKind::Binary) continue;
+            Token at = ast.token(first);
+            std::string_view name = ast.addOwnedText("$t" + std::to_string(temps++));   // $t0, $t1, ...
+            tokenOf[e] = ast.addToken(Token(TokenType::IDENTIFIER, name, at.linha, at.coluna));
+            slotOf[e] = ast.frameSize(x.scope);
+            ast.setFrameSize(x.scope, slotOf[e] + 1);
+            NodeId temp = ast.add(NodeKind::Temp, tokenOf[e], &first, 1);
+            ast.setSlot(temp, x.depth, slotOf[e], ast.type(first));
+            ast.setChild(x.first.parent, x.first.k, temp);
+            ++rewrites;
+        }
+        for (const auto& [e, at] : uses) {
+            if (slotOf[e] == NO_EXPR) continue;
+            NodeId read = ast.add(NodeKind::Identifier, tokenOf[e]);
+            ast.setSlot(read, exprs[e].depth, slotOf[e], ast.type(ast.child(at.parent, at.k)));
+            ast.setChild(at.parent, at.k, read);
+            ++rewrites;
+        }
+    }
+};
+
+// Roda a passada sobre o programa inteiro e devolve quantos nós foram
+// criados ou trocados
+inline size_t eliminateCommonSubexpressions(AstPool& ast) {
+    ValueNumbering vn(ast);
+    vn.run();
+    return vn.rewrites;
+}
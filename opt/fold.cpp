@@ -0,0 +1,286 @@
+// fold.cpp
+// Compiladores - Dobra de constantes e propagação de constantes sobre a AST
+// já checada e especializada, entre a semântica e o executor. Os valores
+// são calculados com as funções do próprio executor (applyBinary,
+// promoteToReal), então as regras de int/real são as mesmas da execução.
+#include <climits>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Valor conhecido de uma variável durante a passada
+struct ConstSlot {
+    bool known = false;
+    LiteralValue value;
+};
+
+// Mesmo valor (reais comparados bit a bit: -0.0 e NaN não se confundem)
+static bool sameConst(const LiteralValue& a, const LiteralValue& b) {
+    if (a.type != b.type) return false;
+    switch (a.type) {
+        case TypeKind::INT:    return a.i == b.i;
+        case TypeKind::REAL:   return std::memcmp(&a.d, &b.d, sizeof(double)) == 0;
+        case TypeKind::STRING: return a.s == b.s;
+        case TypeKind::BOOL:   return a.b == b.b;
+        default:               return false;
+    }
+}
+
+// Texto de um valor dobrado (o que --ast mostra no Literal), com a
+// formatação de --run
+static std::string constText(const LiteralValue& v) {
+    std::ostringstream out;
+    switch (v.type) {
+        case TypeKind::INT:    out << v.i; break;
+        case TypeKind::REAL:   out << v.d; break;
+        case TypeKind::STRING: out << v.s; break;
+        case TypeKind::BOOL:   out << (v.b ? "true" : "false"); break;
+        default:               break;
+    }
+    return out.str();
+}
+
+// Tipo de token de um literal com o valor `v`
+static TokenType constTokenType(const LiteralValue& v) {
+    switch (v.type) {
+        case TypeKind::INT:    return TokenType::NUM_INT;
+        case TypeKind::REAL:   return TokenType::NUM_REAL;
+        case TypeKind::STRING: return TokenType::STRING;
+        default:               return v.b ? TokenType::KW_TRUE : TokenType::KW_FALSE;
+    }
+}
+
+using ConstEnv = SlotEnv<ConstSlot>;
+using ConstWrites = ConstEnv::Writes;
+
+// Valor padrão de uma variável declarada sem inicializador (makeDefault)
+static ConstSlot defaultConst(TypeKind t) {
+    ConstSlot c;
+    c.known = (t != TypeKind::UNKNOWN);
+    c.value.type = t;
+    return c;
+}
+
+// Conversões entre o valor do executor e o literal do pool (a dobra só
+// produz int, real e bool)
+static LiteralValue toLiteral(const RuntimeValue& v) {
+    LiteralValue lit;
+    lit.type = v.type;
+    lit.i = v.i;
+    lit.d = v.d;
+    lit.b = v.b;
+    return lit;
+}
+
+static RuntimeValue toRuntime(const LiteralValue& lit) {
+    RuntimeValue v;
+    v.type = lit.type;
+    v.i = lit.i;
+    v.d = lit.d;
+    v.b = lit.b;
+    return v;
+}
+
+// Operação que não pode ser dobrada sem mudar o comportamento: divisão
+// inteira por zero (ou INT_MIN / -1) fica para a execução
+static bool foldable(ExecOp op, const LiteralValue& l, const LiteralValue& r) {
+    if (op == ExecOp::DivInt || op == ExecOp::ModInt) {
+        return r.i != 0 && !(l.i == INT_MIN && r.i == -1);
+    }
+    return op != ExecOp::None;
+}
+
+// Passada de otimização: percorre os statements na ordem de execução,
+// guardando o valor conhecido de cada variável, e reescreve o pool
+class ConstantFolder {
+public:
+    explicit ConstantFolder(AstPool& a) : ast(a) {}
+
+    size_t rewrites = 0;                   // nós substituídos ou removidos
+
+    void run() {
+        if (ast.root == NO_NODE) return;
+        env.pushFrame(ast.frameSize(ast.root));
+        statements(ast.root);
+    }
+
+private:
+    AstPool& ast;
+    ConstEnv env;
+    std::vector<std::pair<NodeId, bool>> work;     // pilhas de foldExpr
+    std::vector<ConstSlot> values;
+
+    // Nó Literal novo com o valor `v` (no lugar de `from`), na posição de
+    // `from` e com o próprio valor como texto
+    NodeId makeLiteral(NodeId from, const LiteralValue& v) {
+        Token at = ast.token(from);
+        NodeId lit = ast.add(NodeKind::Literal, ast.addToken(Token(constTokenType(v), ast.addOwnedText(constText(v)), at.linha, at.coluna)));
+        ast.setLiteral(lit, v);
+        ast.setType(lit, v.type);
+        ++rewrites;
+        return lit;
+    }
+
+    // Troca um filho constante que ainda não é literal
+    void materialize(NodeId parent, size_t k, const ConstSlot& c) {
+        NodeId kid = ast.child(parent, k);
+        if (c.known && ast.kind(kid) != NodeKind::Literal) ast.setChild(parent, k, makeLiteral(kid, c.value));
+    }
+
+    // Dobra a expressão do filho k de `parent` (pós-ordem com pilhas
+    // explícitas) e devolve o valor dela, se constante
+    ConstSlot foldExpr(NodeId parent, size_t k) {
+        size_t workBase = work.size();
+        size_t valueBase = values.size();
+        work.push_back({ast.child(parent, k), false});
+        while (work.size() > workBase) {
+            auto [node, expanded] = work.back();
+            work.pop_back();
+            NodeKind kind = ast.kind(node);
+            if (kind == NodeKind::Literal) {
+                ConstSlot c;
+                c.value = ast.literal(node);
+                c.known = !c.value.outOfRange;     // erro de execução: não dobra
+                values.push_back(c);
+            } else if (kind == NodeKind::Identifier) {
+                values.push_back(env.get(ast.depth(node), ast.slot(node)));
+            } else if (!expanded) {
+                work.push_back({node, true});
+                for (size_t i = ast.childCount(node); i-- > 0;) work.push_back({ast.child(node, i), false});
+            } else if (kind == NodeKind::Promote) {
+                ConstSlot& c = values.back();
+                if (c.known) c.value = toLiteral(promoteToReal(toRuntime(c.value)));
+            } else if (kind == NodeKind::Temp) {   // leituras do temporário veem o valor
+                materialize(node, 0, values.back());
+                env.set(ast.depth(node), ast.slot(node), values.back());
+            } else {                               // Binary
+                ConstSlot right = values.back();
+                values.pop_back();
+                ConstSlot& left = values.back();
+                if (left.known && right.known && foldable(ast.exec(node), left.value, right.value)) {
+                    left.value = toLiteral(applyBinary(ast, node, toRuntime(left.value), toRuntime(right.value)));
+                } else {
+                    materialize(node, 0, left);
+                    materialize(node, 1, right);
+                    left.known = false;
+                }
+            }
+        }
+        ConstSlot c = values.back();
+        values.resize(valueBase);
+        materialize(parent, k, c);
+        return c;
+    }
+
+    // Filhos de Program/Block: statements removidos saem da lista
+    void statements(NodeId node) {
+        std::vector<NodeId> kids;
+        kids.reserve(ast.childCount(node));
+        bool changed = false;
+        for (size_t i = 0; i < ast.childCount(node); ++i) {
+            NodeId kid = ast.child(node, i);
+            NodeId out = statement(kid);
+            changed = changed || out != kid;
+            if (out != NO_NODE) kids.push_back(out);
+        }
+        if (changed) ast.setChildren(node, kids.data(), kids.size());
+    }
+
+    // Otimiza um statement e devolve o que fica no lugar dele (NO_NODE se
+    // ele some)
+    NodeId statement(NodeId node) {
+        switch (ast.kind(node)) {
+            case NodeKind::Block:
+                env.pushFrame(ast.frameSize(node));
+                statements(node);
+                env.popFrame();
+                return node;
+
+            case NodeKind::Decl: {
+                NodeId var = ast.child(node, 0);
+                ConstSlot c = ast.childCount(node) > 1 ? foldExpr(node, 1) : defaultConst(ast.type(var));
+                env.set(ast.depth(var), ast.slot(var), c);
+                return node;
+            }
+
+            case NodeKind::Assign: {
+                NodeId var = ast.child(node, 0);
+                env.set(ast.depth(var), ast.slot(var), foldExpr(node, 1));
+                return node;
+            }
+
+            case NodeKind::If:
+                return ifStatement(node);
+
+            default:
+                return node;
+        }
+    }
+
+    // Ramo de if isolado: desfeito o ramo, devolve as escritas dele
+    NodeId branch(NodeId node, size_t k, ConstWrites& writes) {
+        size_t m = env.mark();
+        NodeId out = statement(ast.child(node, k));
+        writes = env.writesSince(m, env.depth());
+        env.undo(m);
+        return out;
+    }
+
+    // Ramo que some dentro de outro if vira um bloco vazio
+    NodeId emptyBlock(NodeId from) {
+        NodeId block = ast.add(NodeKind::Block, ast.node(from).token);
+        ast.setFrameSize(block, 0);
+        return block;
+    }
+
+    void setBranch(NodeId node, size_t k, NodeId out) {
+        if (out != ast.child(node, k)) ast.setChild(node, k, out == NO_NODE ? emptyBlock(node) : out);
+    }
+
+    NodeId ifStatement(NodeId node) {
+        ConstSlot cond = foldExpr(node, 0);
+        if (cond.known) {                          // só o ramo tomado fica
+            ++rewrites;
+            if (cond.value.b) return statement(ast.child(node, 1));
+            return ast.childCount(node) > 2 ? statement(ast.child(node, 2)) : NO_NODE;
+        }
+
+        // Cada ramo parte do estado antes do if; na junção, uma variável
+        // escrita em algum ramo só continua conhecida se os dois ramos
+        // deixam o mesmo valor
+        ConstWrites thenWrites, elseWrites;
+        setBranch(node, 1, branch(node, 1, thenWrites));
+        if (ast.childCount(node) > 2) setBranch(node, 2, branch(node, 2, elseWrites));
+
+        // valor no fim do ramo: o escrito nele ou o de antes do if
+        auto valueAfter = [&](const ConstWrites& writes, uint64_t key) {
+            auto it = writes.find(key);
+            return it != writes.end() ? it->second : env.get(static_cast<uint16_t>(key >> 32), static_cast<uint32_t>(key));
+        };
+        ConstWrites joined;
+        for (const ConstWrites* writes : {&thenWrites, &elseWrites}) {
+            for (const auto& w : *writes) {
+                if (joined.count(w.first)) continue;
+                ConstSlot a = valueAfter(thenWrites, w.first);
+                ConstSlot b = valueAfter(elseWrites, w.first);
+                ConstSlot c;
+                c.known = a.known && b.known && sameConst(a.value, b.value);
+                if (c.known) c.value = a.value;
+                joined[w.first] = c;
+            }
+        }
+        for (const auto& j : joined) env.set(static_cast<uint16_t>(j.first >> 32), static_cast<uint32_t>(j.first), j.second);
+        return node;
+    }
+};
+
+// Roda a passada sobre o programa inteiro e devolve quantos nós foram
+// reescritos
+inline size_t foldConstants(AstPool& ast) {
+    ConstantFolder folder(ast);
+    folder.run();
+    return folder.rewrites;
+}
@@ -0,0 +1,108 @@
+// passes.cpp
+// Compiladores - Gerenciador de passes de otimização: uma lista ordenada de
+// transformações AST -> AST escolhida pelo nível (-O0/-O1/-O2) ou dada por
+// nome (--passes), com tempo, tamanho da árvore e reescritas de cada passe
+// para --pass-stats
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Passe: reescreve o pool e devolve quantos nós trocou ou removeu
+using PassFn = size_t (*)(AstPool&);
+
+// Medidas de um passe numa execução
+struct PassStats {
+    std::string name;
+    double ms = 0.0;                   // tempo de parede
+    size_t nodesBefore = 0;            // nós alcançáveis da raiz
+    size_t nodesAfter = 0;
+    size_t rewrites = 0;
+};
+
+// Nós alcançáveis da raiz (o pool também guarda nós que os passes
+// deixaram de usar)
+inline size_t countNodes(const AstPool& ast) {
+    if (ast.root == NO_NODE) return 0;
+    size_t count = 0;
+    std::vector<NodeId> work = {ast.root};
+    while (!work.empty()) {
+        NodeId node = work.back();
+        work.pop_back();
+        ++count;
+        for (size_t i = 0; i < ast.childCount(node); ++i) work.push_back(ast.child(node, i));
+    }
+    return count;
+}
+
+class PassManager {
+public:
+    // Maior nível aceito por -O
+    static constexpr unsigned MAX_LEVEL = 2;
+
+    // Pipeline de cada nível: -O0 nenhum passe; -O1 dobra e propagação de
+    // constantes; -O2 também elimina subexpressões comuns
+    static PassManager forLevel(unsigned level) {
+        PassManager pm;
+        if (level >= 1) pm.add("fold", foldConstants);
+        if (level >= 2) pm.add("cse", eliminateCommonSubexpressions);
+        return pm;
+    }
+
+    // Pipeline de --passes: nomes separados por vírgula, rodados na ordem
+    // dada (ex.: "cse" ou "cse,fold")
+    static PassManager fromList(const std::string& list) {
+        PassManager pm;
+        size_t start = 0;
+        while (start <= list.size()) {
+            size_t end = list.find(',', start);
+            if (end == std::string::npos) end = list.size();
+            std::string name = list.substr(start, end - start);
+            if (name == "fold") pm.add("fold", foldConstants);
+            else if (name == "cse") pm.add("cse", eliminateCommonSubexpressions);
+            else throw std::runtime_error("Passe desconhecido em --passes: '" + name + "' (use fold, cse)");
+            start = end + 1;
+        }
+        return pm;
+    }
+
+    void add(const char* name, PassFn fn) { passes.push_back({name, fn}); }
+    bool empty() const { return passes.empty(); }
+
+    // Roda os passes em ordem; com `stats`, acrescenta as medidas de cada um
+    void run(AstPool& ast, std::vector<PassStats>* stats = nullptr) const {
+        for (const Pass& p : passes) {
+            if (!stats) {
+                p.fn(ast);
+                continue;
+            }
+            PassStats s;
+            s.name = p.name;
+            s.nodesBefore = countNodes(ast);
+            auto start = std::chrono::steady_clock::now();
+            s.rewrites = p.fn(ast);
+            s.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            s.nodesAfter = countNodes(ast);
+            stats->push_back(std::move(s));
+        }
+    }
+
+private:
+    struct Pass {
+        const char* name;
+        PassFn fn;
+    };
+    std::vector<Pass> passes;
+};
+
+// Imprime as medidas de --pass-stats (em stderr, fora da saída do programa)
+inline void printPassStats(const std::vector<PassStats>& stats) {
+    for (const PassStats& s : stats) {
+        char line[160];
+        std::snprintf(line, sizeof(line), "[passe] %-8s %9.3f ms  nos %zu -> %zu  reescritas %zu\n",
+                      s.name.c_str(), s.ms, s.nodesBefore, s.nodesAfter, s.rewrites);
+        std::cerr << line;
+    }
+}
@@ -0,0 +1,67 @@
+// slots.cpp
+// Compiladores - Ambiente por (escopo, slot) dos passes que percorrem os
+// statements na ordem de execução (dobra, CSE, construção do SSA)
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Informação de um passe por variável (escopo, slot), com um frame por
+// bloco aberto como no RuntimeEnv; um slot começa com T{}. Dentro de um
+// ramo de if cada escrita guarda o valor anterior num rastro, desfeito
+// antes do outro ramo.
+template <typename T>
+class SlotEnv {
+public:
+    // Escritas de um ramo: chave (escopo, slot) -> valor no fim do ramo
+    using Writes = std::unordered_map<uint64_t, T>;
+
+    const T& get(uint16_t depth, uint32_t slot) const { return frames[depth][slot]; }
+
+    void set(uint16_t depth, uint32_t slot, T v) {
+        if (branches > 0) trail.push_back({depth, slot, frames[depth][slot]});
+        frames[depth][slot] = std::move(v);
+    }
+
+    void pushFrame(size_t slots) { frames.emplace_back(slots); }
+    void popFrame() { frames.pop_back(); }
+    uint16_t depth() const { return static_cast<uint16_t>(frames.size() - 1); }
+
+    // Ramo de if: escritas a partir de mark() podem ser desfeitas
+    size_t mark() {
+        ++branches;
+        return trail.size();
+    }
+
+    // Variáveis de fora do ramo escritas desde `m`, com o valor atual
+    Writes writesSince(size_t m, uint16_t outerDepth) const {
+        Writes out;
+        for (size_t k = m; k < trail.size(); ++k) {
+            const Undo& u = trail[k];
+            if (u.depth > outerDepth) continue;            // frame do ramo, já fechado
+            out[key(u.depth, u.slot)] = frames[u.depth][u.slot];
+        }
+        return out;
+    }
+
+    // Desfaz as escritas desde `m` e fecha o ramo
+    void undo(size_t m) {
+        for (size_t k = trail.size(); k-- > m;) {
+            const Undo& u = trail[k];
+            if (u.depth < frames.size()) frames[u.depth][u.slot] = u.old;
+        }
+        trail.resize(m);
+        --branches;
+    }
+
+    static uint64_t key(uint16_t depth, uint32_t slot) { return (static_cast<uint64_t>(depth) << 32) | slot; }
+
+private:
+    struct Undo {
+        uint16_t depth;
+        uint32_t slot;
+        T old;
+    };
+    std::vector<std::vector<T>> frames;
+    std::vector<Undo> trail;
+    size_t branches = 0;
+};
@@ -0,0 +1,306 @@
+// ast.cpp
+// Compiladores - AST em pool contíguo, com nós endereçados por índice
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Tipos de nós da AST
+enum class NodeKind : uint8_t {
+    Program,
+    Block,
+    Decl,
+    Assign,
+    If,
+    Binary,
+    Literal,
+    Identifier,
+    Promote,                           // int -> real implícito (criado pela semântica)
+    Temp                               // avalia o filho e guarda o valor no temporário
+                                       // (escopo, slot) do nó (criado pela CSE)
+};
+
+// Definição dos tipos de dados
+enum class TypeKind : uint8_t {
+    INT,
+    REAL,
+    STRING,
+    BOOL,
+    UNKNOWN
+};
+
+// Operador de um nó Binary (preenchido pelo lowering)
+enum class BinaryOp : uint8_t {
+    None,
+    Add, Sub, Mul, Div, Mod,           // + - * / %
+    Eq, Ne, Lt, Le, Gt, Ge,            // == != < <= > >=
+    And, Or                            // && ||
+};
+
+// Operação especializada pelo tipo dos operandos, escolhida pela semântica
+// depois da checagem: o executor roda o nó sem testar tipos. Operandos
+// mistos int/real já chegam promovidos por um nó Promote.
+enum class ExecOp : uint8_t {
+    None,
+    AddInt, SubInt, MulInt, DivInt, ModInt,
+    AddReal, SubReal, MulReal, DivReal,
+    EqInt, NeInt, LtInt, LeInt, GtInt, GeInt,
+    EqReal, NeReal, LtReal, LeReal, GtReal, GeReal,
+    And, Or
+};
+
+// Valor de um literal já decodificado pelo lowering
+struct LiteralValue {
+    TypeKind type = TypeKind::UNKNOWN;
+    bool outOfRange = false;           // número que não cabe no tipo (erro só ao avaliar)
+    int i = 0;
+    double d = 0.0;
+    bool b = false;
+    std::string_view s;                // lexema da string (com aspas)
+};
+
+// Índice de um nó no AstPool
+using NodeId = uint32_t;
+constexpr NodeId NO_NODE = UINT32_MAX;
+
+// Nó da AST: só índices, sem ponteiros nem alocação própria
+struct AstNode {
+    NodeKind kind;
+    BinaryOp op;                       // operador de Binary (após o lowering)
+    uint16_t depth;                    // Identifier: escopo da variável (0 = programa)
+    uint32_t token;                    // token principal (op, id ou literal) na tabela do pool
+    uint32_t firstChild;               // início dos filhos em AstPool::childIndex; em Literal
+                                       // sem filhos, índice em AstPool::literals após o lowering
+    uint32_t childCount;
+    uint32_t slot;                     // Identifier: slot no frame do escopo; Program/Block:
+                                       // tamanho do frame (preenchidos pela semântica)
+    TypeKind type;                     // expressões: tipo estático (em Identifier, o
+                                       // declarado da variável)
+    ExecOp exec;                       // Binary: operação especializada
+};
+
+// Token como fica guardado no pool, sem ponteiros: `text` é relativo à
+// base do pool (zero nos pools montados pelo parser, onde é o próprio
+// endereço; o início da tabela de strings numa imagem binária)
+struct AstToken {
+    uint64_t text;
+    uint32_t length;
+    SymbolId simbolo;
+    int32_t linha;
+    int32_t coluna;
+    TokenType tipo;
+};
+
+// Literal guardado no pool; o lexema da string segue a regra de AstToken
+struct AstLiteral {
+    uint64_t text;
+    double d;
+    int32_t i;
+    uint32_t length;
+    uint8_t type;                      // TypeKind
+    uint8_t outOfRange;
+    uint8_t b;
+};
+
+// Tabelas de uma AST que já estão na memória em outro lugar (imagem
+// binária mapeada, ver parser/astbin.cpp); `owner` mantém o mapeamento vivo
+struct AstImage {
+    const AstNode* nodes = nullptr;
+    const NodeId* childIndex = nullptr;
+    const AstToken* tokens = nullptr;
+    const AstLiteral* literals = nullptr;
+    size_t nodeCount = 0;
+    size_t childCount = 0;
+    size_t tokenCount = 0;
+    size_t literalCount = 0;
+    const char* strings = nullptr;
+    std::shared_ptr<const void> owner;
+};
+
+// Pool com todos os nós de uma AST. Os filhos de cada nó ocupam uma faixa
+// contígua de `childIndex`, e os tokens usados pelos nós ficam numa tabela
+// única (os nós guardam só o índice). Como o parser cria os filhos antes
+// do pai, a raiz é o último nó criado pelo parser (a semântica ainda pode
+// acrescentar nós Promote depois dela). Um pool criado por fromImage() lê as
+// tabelas direto da imagem e é somente leitura.
+class AstPool {
+public:
+    NodeId root = NO_NODE;
+
+    // Pool somente leitura sobre as tabelas de uma imagem, sem cópia
+    static AstPool fromImage(std::shared_ptr<const AstImage> image, NodeId root) {
+        AstPool ast;
+        ast.root = root;
+        ast.textBase = reinterpret_cast<uintptr_t>(image->strings);
+        ast.image = std::move(image);
+        return ast;
+    }
+
+    // Guarda um token na tabela e devolve seu índice
+    uint32_t addToken(const Token& t) {
+        tokens.push_back(packToken(t));
+        return static_cast<uint32_t>(tokens.size() - 1);
+    }
+
+    // Guarda no pool um texto criado depois do parse (literal dobrado,
+    // temporário) para um token ou literal apontar para ele
+    std::string_view addOwnedText(std::string text) {
+        ownedTexts.push_back(std::make_shared<const std::string>(std::move(text)));
+        return *ownedTexts.back();
+    }
+
+    // Cria um nó com os filhos kids[0..count)
+    NodeId add(NodeKind kind, uint32_t token, const NodeId* kids = nullptr, size_t count = 0) {
+        nodes.push_back({kind, BinaryOp::None, 0, token, static_cast<uint32_t>(childIndex.size()),
+                         static_cast<uint32_t>(count), 0, TypeKind::UNKNOWN, ExecOp::None});
+        childIndex.insert(childIndex.end(), kids, kids + count);
+        return static_cast<NodeId>(nodes.size() - 1);
+    }
+
+    size_t size() const { return image ? image->nodeCount : nodes.size(); }
+    const AstNode& node(NodeId id) const { return image ? image->nodes[id] : nodes[id]; }
+    NodeKind kind(NodeId id) const { return node(id).kind; }
+    size_t childCount(NodeId id) const { return node(id).childCount; }
+    NodeId child(NodeId id, size_t k) const { return childSlot(node(id).firstChild + k); }
+    Token token(NodeId id) const { return tableToken(node(id).token); }
+
+    // Dados do lowering
+    BinaryOp op(NodeId id) const { return node(id).op; }
+    LiteralValue literal(NodeId id) const { return literalAt(node(id).firstChild); }
+    void setOp(NodeId id, BinaryOp op) { nodes[id].op = op; }
+    void setLiteral(NodeId id, const LiteralValue& v) {
+        nodes[id].firstChild = static_cast<uint32_t>(literals.size());
+        literals.push_back({reinterpret_cast<uintptr_t>(v.s.data()), v.d, v.i, static_cast<uint32_t>(v.s.size()),
+                            static_cast<uint8_t>(v.type), v.outOfRange, v.b});
+    }
+
+    // Resolução de nomes da semântica: (escopo, slot, tipo) de cada
+    // Identifier e tamanho do frame de Program/Block
+    uint16_t depth(NodeId id) const { return node(id).depth; }
+    uint32_t slot(NodeId id) const { return node(id).slot; }
+    TypeKind type(NodeId id) const { return node(id).type; }
+    uint32_t frameSize(NodeId id) const { return node(id).slot; }
+    void setSlot(NodeId id, uint16_t depth, uint32_t slot, TypeKind type) {
+        nodes[id].depth = depth;
+        nodes[id].slot = slot;
+        nodes[id].type = type;
+    }
+    void setFrameSize(NodeId id, uint32_t slots) { nodes[id].slot = slots; }
+
+    // Tipos da semântica: tipo estático de cada expressão e operação
+    // especializada de Binary
+    ExecOp exec(NodeId id) const { return node(id).exec; }
+    void setType(NodeId id, TypeKind type) { nodes[id].type = type; }
+    void setExec(NodeId id, ExecOp op) { nodes[id].exec = op; }
+
+    // Tabelas cruas, na ordem dos índices (gravação da imagem binária)
+    size_t tokenCount() const { return image ? image->tokenCount : tokens.size(); }
+    size_t childSlots() const { return image ? image->childCount : childIndex.size(); }
+    size_t literalCount() const { return image ? image->literalCount : literals.size(); }
+    NodeId childSlot(size_t k) const { return image ? image->childIndex[k] : childIndex[k]; }
+    Token tableToken(uint32_t k) const {
+        const AstToken& t = image ? image->tokens[k] : tokens[k];
+        return Token(t.tipo, std::string_view(reinterpret_cast<const char*>(textBase + t.text), t.length),
+                     t.linha, t.coluna, t.simbolo);
+    }
+    LiteralValue literalAt(size_t k) const {
+        const AstLiteral& l = image ? image->literals[k] : literals[k];
+        LiteralValue v;
+        v.type = static_cast<TypeKind>(l.type);
+        v.outOfRange = l.outOfRange != 0;
+        v.i = l.i;
+        v.d = l.d;
+        v.b = l.b != 0;
+        v.s = std::string_view(reinterpret_cast<const char*>(textBase + l.text), l.length);
+        return v;
+    }
+
+    // Usados pelo parser incremental para reaproveitar subárvores entre
+    // edições: reapontar tokens deslocados e trocar a lista de filhos
+    void setTableToken(uint32_t k, const Token& t) { tokens[k] = packToken(t); }
+    void setLiteralText(NodeId id, std::string_view s) {
+        AstLiteral& l = literals[nodes[id].firstChild];
+        l.text = reinterpret_cast<uintptr_t>(s.data());
+        l.length = static_cast<uint32_t>(s.size());
+    }
+    void setChild(NodeId id, size_t k, NodeId kid) { childIndex[nodes[id].firstChild + k] = kid; }
+    void setChildren(NodeId id, const NodeId* kids, size_t count) {
+        AstNode& n = nodes[id];
+        if (count > n.childCount) {                     // não cabe: faixa nova no fim
+            n.firstChild = static_cast<uint32_t>(childIndex.size());
+            childIndex.insert(childIndex.end(), kids, kids + count);
+        } else {
+            std::copy(kids, kids + count, childIndex.begin() + n.firstChild);
+        }
+        n.childCount = static_cast<uint32_t>(count);
+    }
+
+    // Concatena pools parseados em separado (statements de topo em ordem):
+    // ids de nós, faixas de filhos, tokens e literais de cada parte são
+    // deslocados, e cada parte é copiada por uma tarefa de `pool`. Como o
+    // parser sequencial numera tudo na mesma ordem, o resultado é idêntico.
+    static AstPool concat(std::vector<AstPool>& parts, ThreadPool& pool) {
+        size_t n = parts.size();
+        std::vector<size_t> nodeBase(n + 1, 0), childBase(n + 1, 0), tokenBase(n + 1, 0), literalBase(n + 1, 0);
+        for (size_t p = 0; p < n; ++p) {
+            nodeBase[p + 1] = nodeBase[p] + parts[p].nodes.size();
+            childBase[p + 1] = childBase[p] + parts[p].childIndex.size();
+            tokenBase[p + 1] = tokenBase[p] + parts[p].tokens.size();
+            literalBase[p + 1] = literalBase[p] + parts[p].literals.size();
+        }
+        AstPool out;
+        out.nodes.resize(nodeBase[n]);
+        out.childIndex.resize(childBase[n]);
+        out.tokens.resize(tokenBase[n]);
+        out.literals.resize(literalBase[n]);
+        for (const AstPool& part : parts) {
+            out.ownedTexts.insert(out.ownedTexts.end(), part.ownedTexts.begin(), part.ownedTexts.end());
+        }
+        pool.parallelFor(n, [&](size_t p) {
+            AstPool& part = parts[p];
+            for (size_t k = 0; k < part.nodes.size(); ++k) {
+                AstNode node = part.nodes[k];
+                node.token += static_cast<uint32_t>(tokenBase[p]);
+                // Literal sem filhos guarda o índice do literal (após o lowering)
+                node.firstChild += static_cast<uint32_t>(node.kind == NodeKind::Literal ? literalBase[p] : childBase[p]);
+                out.nodes[nodeBase[p] + k] = node;
+            }
+            for (size_t k = 0; k < part.childIndex.size(); ++k) {
+                out.childIndex[childBase[p] + k] = part.childIndex[k] + static_cast<NodeId>(nodeBase[p]);
+            }
+            std::copy(part.tokens.begin(), part.tokens.end(), out.tokens.begin() + static_cast<ptrdiff_t>(tokenBase[p]));
+            std::copy(part.literals.begin(), part.literals.end(), out.literals.begin() + static_cast<ptrdiff_t>(literalBase[p]));
+            part = AstPool();                           // libera a parte
+        });
+        return out;
+    }
+
+    // Texto do nó: nome da variável em Decl, rótulo fixo em nós de
+    // estrutura e o lexema nos demais
+    std::string_view value(NodeId id) const {
+        switch (node(id).kind) {
+            case NodeKind::Program: return "program";
+            case NodeKind::Block:   return "block";
+            case NodeKind::If:      return "if";
+            case NodeKind::Assign:  return "=";
+            case NodeKind::Decl:    return token(child(id, 0)).texto;
+            default:                return token(id).texto;
+        }
+    }
+
+private:
+    std::vector<AstNode> nodes;
+    std::vector<NodeId> childIndex;
+    std::vector<AstToken> tokens;
+    std::vector<AstLiteral> literals;
+    std::vector<std::shared_ptr<const std::string>> ownedTexts;    // de addOwnedText (cópias do pool dividem)
+    std::shared_ptr<const AstImage> image;      // só em pools de fromImage()
+    uintptr_t textBase = 0;
+
+    static AstToken packToken(const Token& t) {
+        return {reinterpret_cast<uintptr_t>(t.texto.data()), static_cast<uint32_t>(t.texto.size()),
+                t.simbolo, t.linha, t.coluna, t.tipo};
+    }
+};
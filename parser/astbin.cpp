@@ -0,0 +1,381 @@
+// astbin.cpp
+// Compiladores - Imagem binária da AST: gravada uma vez (--emit-ast-bin) e
+// depois mapeada em memória e usada direto pela semântica e pelo executor
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Layout do arquivo (little-endian, seções alinhadas em 8 bytes):
+//   AstBinHeader
+//   nós         AstNode[nodeCount]
+//   filhos      NodeId[childCount]
+//   tokens      AstToken[tokenCount]   (text relativo à tabela de strings)
+//   literais    AstLiteral[literalCount]
+//   nomes       AstBinName[symbolCount] (id do Interner -> texto)
+//   globais     SymbolId[n]: nome de cada slot do frame do programa
+//   strings     bytes dos lexemas e nomes
+// As tabelas têm o mesmo formato das do AstPool, então carregar é só
+// validar o cabeçalho e apontar o pool para dentro do mapeamento. Só
+// programas sem erros viram imagem, e os nós já vêm resolvidos pela
+// semântica (slots), então carregar dispensa a checagem; a árvore
+// alcançável da raiz é conferida (índices, formato dos nós e slots) para
+// que uma imagem adulterada não leve o executor a ler fora das tabelas.
+constexpr char AST_BIN_MAGIC[8] = {'M', 'C', 'A', 'S', 'T', 'B', 'I', 'N'};
+constexpr uint32_t AST_BIN_VERSION = 6;
+constexpr uint32_t AST_BIN_BYTE_ORDER = 0x01020304;
+
+// Hash de 64 bits de um bloco de bytes, 8 bytes por passo (chave do cache
+// e checksum da imagem)
+inline uint64_t hashBytes(std::string_view data, uint64_t seed = 0) {
+    const uint64_t M = 0x9E3779B97F4A7C15ull;
+    uint64_t h = seed ^ (data.size() * M);
+    size_t k = 0;
+    for (; k + 8 <= data.size(); k += 8) {
+        uint64_t w;
+        std::memcpy(&w, data.data() + k, 8);
+        h = (h ^ (w * M)) * 0xFF51AFD7ED558CCDull;
+        h ^= h >> 29;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, data.data() + k, data.size() - k);
+    h = (h ^ (tail * M)) * 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 32;
+    return h;
+}
+
+// Origem de uma imagem: hash e tamanho do fonte, identificação do
+// compilador que a gerou (zeros numa imagem avulsa de --emit-ast-bin) e
+// nível de otimização da AST gravada
+struct AstBinKey {
+    uint64_t sourceHash = 0;
+    uint64_t sourceSize = 0;
+    uint64_t compilerId = 0;
+    uint64_t optLevel = 0;
+};
+
+struct AstBinSection {
+    uint64_t offset;                   // a partir do início do arquivo
+    uint64_t count;                    // elementos (bytes nas strings)
+};
+
+struct AstBinHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t nodeSize, tokenSize, literalSize, nameSize;   // sizeof de cada registro
+    NodeId root;
+    uint32_t reserved;
+    AstBinKey key;
+    uint64_t checksum;                 // hashBytes de tudo o que vem após o cabeçalho
+    AstBinSection nodes, children, tokens, literals, names, globals, strings;
+};
+
+// Nome de um símbolo na tabela de strings
+struct AstBinName {
+    uint64_t text;
+    uint32_t length;
+    uint32_t reserved;
+};
+
+static_assert(std::is_trivially_copyable<AstNode>::value && std::is_trivially_copyable<AstToken>::value &&
+              std::is_trivially_copyable<AstLiteral>::value, "tabelas do pool precisam ser copiáveis byte a byte");
+
+// AST carregada de uma imagem: o pool somente leitura e os nomes dos
+// símbolos (para mensagens e para o estado final do --run)
+class AstBinary {
+public:
+    AstPool ast;
+
+    std::string_view name(SymbolId id) const {
+        const AstBinName& n = names[id];
+        return std::string_view(strings + n.text, n.length);
+    }
+    size_t symbolCount() const { return nameCount; }
+    const AstBinKey& key() const { return header.key; }
+
+    // id do nome de cada slot do frame do programa
+    size_t globalCount() const { return globalSlots; }
+    SymbolId globalSymbol(size_t slot) const { return globals[slot]; }
+
+    // Verdadeiro se `data` começa com o cabeçalho de uma imagem
+    static bool isImage(std::string_view data) {
+        return data.size() >= sizeof(AST_BIN_MAGIC) && std::memcmp(data.data(), AST_BIN_MAGIC, sizeof(AST_BIN_MAGIC)) == 0;
+    }
+
+    // Carrega a imagem mapeada em `buffer` (mantido vivo pelo pool). São
+    // validados o cabeçalho, os limites das seções e os nós alcançáveis da
+    // raiz (validateTree). Com `verify`, o checksum do conteúdo também é
+    // conferido.
+    static AstBinary load(std::shared_ptr<SourceBuffer> buffer, bool verify = false) {
+        std::string_view data = buffer->text();
+        if (!isImage(data) || data.size() < sizeof(AstBinHeader)) {
+            throw std::runtime_error("Imagem de AST invalida: cabecalho ausente");
+        }
+        AstBinHeader h;
+        std::memcpy(&h, data.data(), sizeof(h));
+        if (h.version != AST_BIN_VERSION) {
+            throw std::runtime_error("Imagem de AST na versao " + std::to_string(h.version) +
+                                     ", esperada " + std::to_string(AST_BIN_VERSION));
+        }
+        if (h.byteOrder != AST_BIN_BYTE_ORDER || h.nodeSize != sizeof(AstNode) || h.tokenSize != sizeof(AstToken) ||
+            h.literalSize != sizeof(AstLiteral) || h.nameSize != sizeof(AstBinName)) {
+            throw std::runtime_error("Imagem de AST gerada em outra plataforma");
+        }
+        checkSection(h.nodes, sizeof(AstNode), data.size());
+        checkSection(h.children, sizeof(NodeId), data.size());
+        checkSection(h.tokens, sizeof(AstToken), data.size());
+        checkSection(h.literals, sizeof(AstLiteral), data.size());
+        checkSection(h.names, sizeof(AstBinName), data.size());
+        checkSection(h.globals, sizeof(SymbolId), data.size());
+        checkSection(h.strings, 1, data.size());
+        if (h.root >= h.nodes.count) throw std::runtime_error("Imagem de AST invalida: raiz fora da tabela");
+        if (verify && hashBytes(data.substr(sizeof(h))) != h.checksum) {
+            throw std::runtime_error("Imagem de AST corrompida: checksum nao confere");
+        }
+
+        const char* base = data.data();
+        validateTree(h, base);
+        auto image = std::make_shared<AstImage>();
+        image->nodes = reinterpret_cast<const AstNode*>(base + h.nodes.offset);
+        image->childIndex = reinterpret_cast<const NodeId*>(base + h.children.offset);
+        image->tokens = reinterpret_cast<const AstToken*>(base + h.tokens.offset);
+        image->literals = reinterpret_cast<const AstLiteral*>(base + h.literals.offset);
+        image->nodeCount = h.nodes.count;
+        image->childCount = h.children.count;
+        image->tokenCount = h.tokens.count;
+        image->literalCount = h.literals.count;
+        image->strings = base + h.strings.offset;
+        image->owner = buffer;
+
+        AstBinary out;
+        out.header = h;
+        out.globals = reinterpret_cast<const SymbolId*>(base + h.globals.offset);
+        out.globalSlots = h.globals.count;
+        out.names = reinterpret_cast<const AstBinName*>(base + h.names.offset);
+        out.nameCount = h.names.count;
+        out.strings = image->strings;
+        out.ast = AstPool::fromImage(std::move(image), h.root);
+        return out;
+    }
+
+private:
+    AstBinHeader header{};
+    const SymbolId* globals = nullptr;
+    size_t globalSlots = 0;
+    const AstBinName* names = nullptr;
+    size_t nameCount = 0;
+    const char* strings = nullptr;
+
+    // seção alinhada e inteira dentro do arquivo
+    static void checkSection(const AstBinSection& s, size_t elemSize, size_t fileSize) {
+        if (s.offset % 8 != 0 || s.offset > fileSize || s.count > (fileSize - s.offset) / elemSize) {
+            throw std::runtime_error("Imagem de AST invalida: secao fora do arquivo");
+        }
+    }
+
+    [[noreturn]] static void invalid(const char* what) {
+        throw std::runtime_error(std::string("Imagem de AST invalida: ") + what);
+    }
+
+    // Texto [text, text + length) dentro da tabela de strings
+    static bool inStrings(uint64_t text, uint64_t length, const AstBinHeader& h) {
+        return text <= h.strings.count && length <= h.strings.count - text;
+    }
+
+    // Confere o que o executor e o --ast leem da árvore: cada nó alcançável
+    // da raiz aparece uma vez (sem ciclos), tem filhos e token dentro das
+    // tabelas e o formato que a semântica produz, e cada variável cai num
+    // frame aberto. Também os nomes e os textos das tabelas.
+    static void validateTree(const AstBinHeader& h, const char* base) {
+        const AstNode* nodes = reinterpret_cast<const AstNode*>(base + h.nodes.offset);
+        const NodeId* children = reinterpret_cast<const NodeId*>(base + h.children.offset);
+        const AstToken* tokens = reinterpret_cast<const AstToken*>(base + h.tokens.offset);
+        const AstLiteral* literals = reinterpret_cast<const AstLiteral*>(base + h.literals.offset);
+        const AstBinName* names = reinterpret_cast<const AstBinName*>(base + h.names.offset);
+        const SymbolId* globals = reinterpret_cast<const SymbolId*>(base + h.globals.offset);
+
+        for (uint64_t k = 0; k < h.tokens.count; ++k) {
+            const AstToken& t = tokens[k];
+            if (!inStrings(t.text, t.length, h)) invalid("token fora da tabela de strings");
+            if (t.simbolo != NO_SYMBOL && t.simbolo >= h.names.count) invalid("nome fora da tabela");
+        }
+        for (uint64_t k = 0; k < h.literals.count; ++k) {
+            const AstLiteral& l = literals[k];
+            if (!inStrings(l.text, l.length, h) || l.type > static_cast<uint8_t>(TypeKind::UNKNOWN)) invalid("literal");
+        }
+        for (uint64_t k = 0; k < h.names.count; ++k) {
+            if (!inStrings(names[k].text, names[k].length, h)) invalid("nome fora da tabela de strings");
+        }
+        for (uint64_t k = 0; k < h.globals.count; ++k) {
+            if (globals[k] >= h.names.count) invalid("nome de variavel do programa");
+        }
+
+        // Percurso com pilha explícita; uma marca de saída fecha o frame de
+        // cada Program/Block
+        enum class Want : uint8_t { Statement, Expr, Var, CloseFrame };
+        std::vector<uint8_t> seen(h.nodes.count, 0);
+        std::vector<uint64_t> frames;
+        std::vector<std::pair<NodeId, Want>> work = {{h.root, Want::Statement}};
+        while (!work.empty()) {
+            auto [id, want] = work.back();
+            work.pop_back();
+            if (want == Want::CloseFrame) {
+                frames.pop_back();
+                continue;
+            }
+            if (id >= h.nodes.count || seen[id]) invalid("filho fora da tabela ou repetido");
+            seen[id] = 1;
+            const AstNode& n = nodes[id];
+            if (n.token >= h.tokens.count) invalid("token fora da tabela");
+            if (n.type > TypeKind::UNKNOWN || n.exec > ExecOp::Or) invalid("tipo ou operacao");
+            if (n.firstChild > h.children.count || n.childCount > h.children.count - n.firstChild) {
+                if (n.kind != NodeKind::Literal) invalid("filhos fora da tabela");
+            }
+
+            size_t minKids = 0, maxKids = 0;
+            bool ok;
+            switch (n.kind) {
+                case NodeKind::Program:    ok = want == Want::Statement && id == h.root; maxKids = SIZE_MAX; break;
+                case NodeKind::Block:      ok = want == Want::Statement && id != h.root; maxKids = SIZE_MAX; break;
+                case NodeKind::Decl:       ok = want == Want::Statement; minKids = 1; maxKids = 2; break;
+                case NodeKind::Assign:     ok = want == Want::Statement; minKids = maxKids = 2; break;
+                case NodeKind::If:         ok = want == Want::Statement; minKids = 2; maxKids = 3; break;
+                case NodeKind::Binary:     ok = want == Want::Expr; minKids = maxKids = 2; break;
+                case NodeKind::Promote:
+                case NodeKind::Temp:       ok = want == Want::Expr; minKids = maxKids = 1; break;
+                case NodeKind::Literal:    ok = want == Want::Expr && n.firstChild < h.literals.count; break;
+                case NodeKind::Identifier: ok = want == Want::Expr || want == Want::Var; break;
+                default:                   ok = false; break;
+            }
+            if (!ok || n.childCount < minKids || n.childCount > maxKids) invalid("no fora do formato");
+            if (n.kind == NodeKind::Identifier || n.kind == NodeKind::Temp) {
+                if (n.depth >= frames.size() || n.slot >= frames[n.depth]) invalid("variavel fora do frame");
+            }
+
+            if (n.kind == NodeKind::Program || n.kind == NodeKind::Block) {
+                // cada slot vem de um Decl ou Temp, então o frame não passa do número de nós
+                if (n.slot > h.nodes.count) invalid("frame maior que a arvore");
+                frames.push_back(n.slot);
+                work.push_back({id, Want::CloseFrame});
+            }
+            for (size_t k = n.childCount; k-- > 0;) {
+                Want kid = Want::Expr;
+                if (n.kind == NodeKind::Program || n.kind == NodeKind::Block) kid = Want::Statement;
+                else if ((n.kind == NodeKind::Decl || n.kind == NodeKind::Assign) && k == 0) kid = Want::Var;
+                else if (n.kind == NodeKind::If && k > 0) kid = Want::Statement;
+                work.push_back({children[n.firstChild + k], kid});
+            }
+        }
+        if (h.globals.count > nodes[h.root].slot) invalid("mais nomes que slots no programa");
+    }
+};
+
+// Serializa `ast` (já checado e sem erros), os nomes de `symbols` e os
+// nomes dos slots do programa (`globals`) numa imagem. Os lexemas são
+// copiados para a tabela de strings, então a imagem não depende do fonte.
+inline std::string serializeAst(const AstPool& ast, const Interner& symbols,
+                                const std::vector<SymbolId>& globals, const AstBinKey& key = {}) {
+    std::string strings;
+    auto addText = [&strings](std::string_view s) {
+        uint64_t off = strings.size();
+        strings.append(s.data(), s.size());
+        return off;
+    };
+
+    std::vector<AstNode> nodes(ast.size());
+    for (NodeId id = 0; id < ast.size(); ++id) {
+        const AstNode& n = ast.node(id);
+        std::memset(&nodes[id], 0, sizeof(AstNode));   // padding zerado: saída determinística
+        nodes[id].kind = n.kind;
+        nodes[id].op = n.op;
+        nodes[id].depth = n.depth;
+        nodes[id].token = n.token;
+        nodes[id].firstChild = n.firstChild;
+        nodes[id].childCount = n.childCount;
+        nodes[id].slot = n.slot;
+        nodes[id].type = n.type;
+        nodes[id].exec = n.exec;
+    }
+    std::vector<NodeId> children(ast.childSlots());
+    for (size_t k = 0; k < children.size(); ++k) children[k] = ast.childSlot(k);
+
+    std::vector<AstToken> tokens(ast.tokenCount());
+    for (uint32_t k = 0; k < tokens.size(); ++k) {
+        Token t = ast.tableToken(k);
+        AstToken& out = tokens[k];
+        std::memset(&out, 0, sizeof(AstToken));
+        out.text = addText(t.texto);
+        out.length = static_cast<uint32_t>(t.texto.size());
+        out.simbolo = t.simbolo;
+        out.linha = t.linha;
+        out.coluna = t.coluna;
+        out.tipo = t.tipo;
+    }
+    std::vector<AstLiteral> literals(ast.literalCount());
+    for (size_t k = 0; k < literals.size(); ++k) {
+        LiteralValue v = ast.literalAt(k);
+        AstLiteral& out = literals[k];
+        std::memset(&out, 0, sizeof(AstLiteral));
+        out.text = v.s.empty() ? 0 : addText(v.s);
+        out.length = static_cast<uint32_t>(v.s.size());
+        out.d = v.d;
+        out.i = v.i;
+        out.type = static_cast<uint8_t>(v.type);
+        out.outOfRange = v.outOfRange;
+        out.b = v.b;
+    }
+    std::vector<AstBinName> names(symbols.size());
+    for (SymbolId id = 0; id < names.size(); ++id) {
+        std::string_view s = symbols.name(id);
+        names[id] = {addText(s), static_cast<uint32_t>(s.size()), 0};
+    }
+
+    AstBinHeader h;
+    std::memset(static_cast<void*>(&h), 0, sizeof(h));
+    std::memcpy(h.magic, AST_BIN_MAGIC, sizeof(AST_BIN_MAGIC));
+    h.version = AST_BIN_VERSION;
+    h.byteOrder = AST_BIN_BYTE_ORDER;
+    h.nodeSize = sizeof(AstNode);
+    h.tokenSize = sizeof(AstToken);
+    h.literalSize = sizeof(AstLiteral);
+    h.nameSize = sizeof(AstBinName);
+    h.root = ast.root;
+    h.key = key;
+
+    std::string out(sizeof(h), '\0');
+    auto section = [&out](AstBinSection& s, const void* data, size_t count, size_t elemSize) {
+        out.resize((out.size() + 7) & ~size_t(7), '\0');
+        s.offset = out.size();
+        s.count = count;
+        out.append(static_cast<const char*>(data), count * elemSize);
+    };
+    section(h.nodes, nodes.data(), nodes.size(), sizeof(AstNode));
+    section(h.children, children.data(), children.size(), sizeof(NodeId));
+    section(h.tokens, tokens.data(), tokens.size(), sizeof(AstToken));
+    section(h.literals, literals.data(), literals.size(), sizeof(AstLiteral));
+    section(h.names, names.data(), names.size(), sizeof(AstBinName));
+    section(h.globals, globals.data(), globals.size(), sizeof(SymbolId));
+    section(h.strings, strings.data(), strings.size(), 1);
+    h.checksum = hashBytes(std::string_view(out).substr(sizeof(h)));
+    std::memcpy(&out[0], &h, sizeof(h));
+    return out;
+}
+
+// Grava uma imagem de serializeAst em `filename`
+inline void writeAstBinary(const std::string& filename, const std::string& image) {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file) throw std::runtime_error("Nao foi possivel criar: " + filename);
+    file.write(image.data(), static_cast<std::streamsize>(image.size()));
+    if (!file) throw std::runtime_error("Falha ao gravar: " + filename);
+}
+
+// Mapeia e carrega uma imagem gravada por writeAstBinary
+inline AstBinary loadAstBinary(const std::string& filename, bool verify = false) {
+    return AstBinary::load(SourceBuffer::fromFile(filename), verify);
+}
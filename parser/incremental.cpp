@@ -0,0 +1,337 @@
+// incremental.cpp
+// Compiladores - Reparse incremental: após uma edição, só os statements
+// tocados são parseados de novo e costurados na AST anterior
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Statement de programa/bloco já parseado, chaveado pela faixa de tokens
+// e pelo hash do conteúdo. Blocos guardam os próprios statements em `inner`.
+struct StatementRecord {
+    uint32_t first, end;                // tokens [first, end) do fluxo
+    uint64_t hash;                      // tipo + texto dos tokens (0 em blocos)
+    NodeId node;
+    uint32_t poolFirst, poolEnd;        // tokens no pool (fora de blocos)
+    NodeId nodeFirst, nodeEnd;          // nós no pool (fora de blocos)
+    size_t liveNodes;                   // nós alcançáveis a partir de `node`
+    std::vector<StatementRecord> inner; // statements de um bloco
+};
+
+// Hash (FNV-1a) do tipo e do texto dos tokens [first, end), sem comentários
+inline uint64_t hashTokens(const std::vector<Token>& tokens, size_t first, size_t end) {
+    uint64_t h = 14695981039346656037ull;
+    auto mix = [&h](unsigned char c) { h ^= c; h *= 1099511628211ull; };
+    for (size_t k = first; k < end; ++k) {
+        if (tokens[k].tipo == TokenType::COMMENT) continue;
+        mix(static_cast<unsigned char>(tokens[k].tipo));
+        for (char c : tokens[k].texto) mix(static_cast<unsigned char>(c));
+    }
+    return h;
+}
+
+// Mantém fonte, tokens e AST entre edições. Cada edição é relexada com
+// relexEdit; os statements (de topo ou dentro de blocos) cujos tokens ou
+// lookahead a edição toca são parseados de novo, e os demais continuam no
+// pool: os de antes ficam como estão e os de depois só têm os tokens
+// reapontados. Nós descartados ficam no pool até a próxima compactação
+// (um parse completo quando o lixo passa da metade).
+class IncrementalParser {
+public:
+    explicit IncrementalParser(std::string text) : source(std::move(text)) {
+        source.reserve(source.size() * 2 + 4096);   // edições cabem sem mover o buffer
+        tokens = tokenizeSource(source, &symbols);
+        fullParse();
+    }
+
+    IncrementalParser(const IncrementalParser&) = delete;   // tokens apontam para `source`
+    IncrementalParser& operator=(const IncrementalParser&) = delete;
+
+    // AST atual (já com lowering); lança se a última edição deixou erro sintático
+    const AstPool& tree() const {
+        if (!valid) throw std::runtime_error("AST indisponivel: a ultima edicao tem erro sintatico");
+        return ast;
+    }
+
+    std::string_view text() const { return source; }
+    const std::vector<Token>& tokenList() const { return tokens; }
+    const Interner& interner() const { return symbols; }
+
+    // statements parseados pela última edição (ou pelo parse completo)
+    size_t lastReparsed() const { return reparsed; }
+
+    // Aplica `e` ao texto e atualiza tokens e AST. Um erro sintático é
+    // lançado como no Parser; a próxima edição então reparseia tudo.
+    void edit(const TextEdit& e) {
+        if (e.inicio > source.size() || e.removidos > source.size() - e.inicio) {
+            throw std::runtime_error("Edicao fora do texto");
+        }
+        std::string inserted(e.inserido);           // pode apontar para o próprio texto
+        TokenShift sh = measureShift(e, inserted);
+
+        const char* oldBase = source.data();
+        size_t oldSize = source.size();
+        source.replace(e.inicio, e.removidos, inserted);
+        RelexResult r = relexEdit(tokens, std::string_view(oldBase, oldSize), source,
+                                  TextEdit{e.inicio, e.removidos, inserted}, symbols);
+        sh.colShift = columnAt(source, e.inicio + inserted.size()) - sh.colShift;
+
+        bool moved = source.data() != oldBase;
+        bool tooMuchGarbage = ast.size() > 2 * liveNodes + 4096 ||
+                              ast.childSlots() > 2 * ast.size() + 4096;
+        if (moved || !valid || tooMuchGarbage) {
+            fullParse();
+            return;
+        }
+
+        EditWindow w{r.primeiro, r.primeiro + r.removidos, r.primeiro + r.inseridos,
+                     static_cast<ptrdiff_t>(r.inseridos) - static_cast<ptrdiff_t>(r.removidos), sh};
+        reparsed = 0;
+        try {
+            if (!spliceList(records, ast.root, 0, 0, tokens.size() - 1, w)) {
+                fullParse();
+                return;
+            }
+        } catch (...) {
+            valid = false;
+            throw;
+        }
+        // o nó program usa o último token do fluxo
+        ast.setTableToken(ast.node(ast.root).token, tokens.size() >= 2 ? tokens[tokens.size() - 2] : tokens.back());
+    }
+
+private:
+    std::string source;
+    Interner symbols;
+    std::vector<Token> tokens;
+    AstPool ast;
+    std::vector<StatementRecord> records;   // statements de topo
+    size_t liveNodes = 0;
+    size_t reparsed = 0;
+    bool valid = false;
+
+    // Deslocamento dos tokens que ficam depois da edição (mesma regra do
+    // relexEdit): offset + delta, linha + lineShift e, na linha onde a
+    // edição terminava, coluna + colShift
+    struct TokenShift {
+        size_t editEnd;
+        ptrdiff_t delta;
+        int lineShift;
+        int endLine;
+        int colShift;
+    };
+
+    // Trecho do fluxo trocado pela edição: tokens antigos [first, oldEnd)
+    // viraram [first, newEnd); os seguintes andaram `tokens` posições
+    struct EditWindow {
+        size_t first, oldEnd, newEnd;
+        ptrdiff_t tokens;
+        TokenShift shift;
+    };
+
+    // coluna (1 + bytes desde o último '\n') do offset `off`
+    static int columnAt(std::string_view text, size_t off) {
+        size_t nl = off == 0 ? std::string_view::npos : text.rfind('\n', off - 1);
+        return static_cast<int>(off - (nl == std::string_view::npos ? 0 : nl + 1)) + 1;
+    }
+
+    // Mede a edição sobre o texto antigo (colShift guarda por enquanto a
+    // coluna antiga do fim da edição)
+    TokenShift measureShift(const TextEdit& e, const std::string& inserted) const {
+        TokenShift sh;
+        sh.editEnd = e.inicio + e.removidos;
+        sh.delta = static_cast<ptrdiff_t>(inserted.size()) - static_cast<ptrdiff_t>(e.removidos);
+        std::string_view removed(source.data() + e.inicio, e.removidos);
+        sh.lineShift = static_cast<int>(std::count(inserted.begin(), inserted.end(), '\n')) -
+                       static_cast<int>(std::count(removed.begin(), removed.end(), '\n'));
+        sh.colShift = columnAt(source, sh.editEnd);
+
+        // linha do fim da edição: a do primeiro token a partir dele, menos as
+        // quebras entre os dois
+        auto offsetOf = [&](const Token& t) {
+            if (t.tipo == TokenType::END_OF_FILE) return source.size();
+            return static_cast<size_t>(t.texto.data() - source.data());
+        };
+        auto it = std::partition_point(tokens.begin(), tokens.end() - 1,
+            [&](const Token& t) { return offsetOf(t) < sh.editEnd; });
+        size_t off = offsetOf(*it);
+        sh.endLine = it->linha - static_cast<int>(std::count(source.begin() + static_cast<ptrdiff_t>(sh.editEnd),
+                                                             source.begin() + static_cast<ptrdiff_t>(off), '\n'));
+        return sh;
+    }
+
+    void shiftToken(Token& t, const TokenShift& sh) {
+        size_t off = static_cast<size_t>(t.texto.data() - source.data());
+        t.texto = std::string_view(source.data() + off + sh.delta, t.texto.size());
+        if (t.linha == sh.endLine) t.coluna += sh.colShift;
+        t.linha += sh.lineShift;
+    }
+
+    void shiftPoolToken(uint32_t k, const TokenShift& sh) {
+        Token t = ast.tableToken(k);
+        shiftToken(t, sh);
+        ast.setTableToken(k, t);
+    }
+
+    // Edição que não desloca nada (mesmo tamanho, mesmas linhas e tokens)
+    static bool isIdentity(const EditWindow& w) {
+        return w.tokens == 0 && w.shift.delta == 0 && w.shift.lineShift == 0 && w.shift.colShift == 0;
+    }
+
+    // Reaponta um statement reaproveitado que fica depois da edição
+    void shiftRecord(StatementRecord& rec, const EditWindow& w) {
+        rec.first = static_cast<uint32_t>(rec.first + w.tokens);
+        rec.end = static_cast<uint32_t>(rec.end + w.tokens);
+        if (ast.kind(rec.node) == NodeKind::Block) {
+            shiftPoolToken(ast.node(rec.node).token, w.shift);
+            for (auto& in : rec.inner) shiftRecord(in, w);
+            return;
+        }
+        for (uint32_t k = rec.poolFirst; k < rec.poolEnd; ++k) shiftPoolToken(k, w.shift);
+        for (NodeId id = rec.nodeFirst; id < rec.nodeEnd; ++id) {   // literais guardam o lexema
+            if (ast.kind(id) == NodeKind::Literal && ast.literal(id).type == TypeKind::STRING) {
+                ast.setLiteralText(id, ast.token(id).texto);
+            }
+        }
+    }
+
+    // Monta os registros de uma lista de nível `depth` a partir dos spans
+    // do parser (que chegam em ordem de término: filhos antes do bloco)
+    void buildRecords(const std::vector<StatementSpan>& spans, size_t depth,
+                      std::vector<StatementRecord>& out) {
+        std::vector<std::vector<StatementRecord>> levels(1);
+        for (const StatementSpan& sp : spans) {
+            size_t rd = sp.depth - depth;
+            if (levels.size() < rd + 2) levels.resize(rd + 2);
+            StatementRecord rec{sp.first, sp.end, 0, sp.node, sp.poolFirst, sp.poolEnd,
+                                sp.nodeFirst, sp.nodeEnd, sp.nodeEnd - sp.nodeFirst, {}};
+            if (ast.kind(sp.node) == NodeKind::Block) {
+                rec.inner = std::move(levels[rd + 1]);
+                rec.liveNodes = 1;
+                for (const auto& in : rec.inner) rec.liveNodes += in.liveNodes;
+            } else {
+                rec.hash = hashTokens(tokens, sp.first, sp.end);
+            }
+            for (size_t l = rd + 1; l < levels.size(); ++l) levels[l].clear();
+            levels[rd].push_back(std::move(rec));
+        }
+        out = std::move(levels[0]);
+    }
+
+    void fullParse() {
+        valid = false;
+        std::vector<StatementSpan> spans;
+        Parser p(tokens);
+        p.recordStatements(&spans);
+        ast = p.parse();
+        records.clear();
+        buildRecords(spans, 0, records);
+        liveNodes = ast.size();
+        reparsed = records.size();
+        valid = true;
+    }
+
+    // Reparseia os statements da lista `recs` (filhos de `listNode`, nível
+    // `depth`) tocados pela edição e costura o resultado. `levelStart` é o
+    // primeiro token da lista e `levelEnd` o índice novo do '}' que a fecha
+    // (ou do EOF no programa). Devolve false, sem mudar `recs`, se a edição
+    // mexeu nos limites da lista; o nível de fora então reparseia o bloco.
+    bool spliceList(std::vector<StatementRecord>& recs, NodeId listNode, size_t depth,
+                    size_t levelStart, size_t levelEnd, const EditWindow& w) {
+        // primeiro statement afetado: o que termina no token trocado ou depois
+        // (um if olha um token além do fim, atrás de um else)
+        size_t i0 = static_cast<size_t>(std::partition_point(recs.begin(), recs.end(),
+            [&](const StatementRecord& r) { return r.end < w.first; }) - recs.begin());
+
+        // edição inteira dentro de um bloco, sem tocar as chaves: desce nele
+        if (i0 < recs.size()) {
+            StatementRecord& b = recs[i0];
+            if (ast.kind(b.node) == NodeKind::Block && b.first < w.first && b.end > w.oldEnd) {
+                bool inside = false;
+                size_t liveBefore = liveNodes;
+                size_t closeBrace = static_cast<size_t>(static_cast<ptrdiff_t>(b.end) - 1 + w.tokens);
+                try {
+                    inside = spliceList(b.inner, b.node, depth + 1, b.first + 1, closeBrace, w);
+                } catch (const std::runtime_error&) {
+                    inside = false;                 // talvez o bloco tenha mudado de forma
+                }
+                if (inside) {
+                    b.end = static_cast<uint32_t>(b.end + w.tokens);
+                    b.liveNodes += liveNodes - liveBefore;     // ajustado lá dentro
+                    if (!isIdentity(w)) {
+                        for (size_t k = i0 + 1; k < recs.size(); ++k) shiftRecord(recs[k], w);
+                    }
+                    return true;
+                }
+            }
+        }
+
+        // parseia a partir do fim do último statement intacto até o fluxo
+        // terminar um statement no mesmo ponto (deslocado) de um antigo
+        size_t start = i0 > 0 ? recs[i0 - 1].end : levelStart;
+        NodeId nodeMark = static_cast<NodeId>(ast.size());
+        std::vector<StatementSpan> spans;
+        Parser p(tokens, start, std::move(ast));
+        p.recordStatements(&spans);
+        size_t k = i0;
+        size_t reuseFrom = recs.size();
+        bool synced = false;
+        try {
+            while (p.parseListItem(depth) != NO_NODE) {
+                ptrdiff_t pos = static_cast<ptrdiff_t>(p.position());
+                while (k < recs.size() && (recs[k].end < w.oldEnd ||
+                                           static_cast<ptrdiff_t>(recs[k].end) + w.tokens < pos)) {
+                    k++;
+                }
+                if (k < recs.size() && static_cast<ptrdiff_t>(recs[k].end) + w.tokens == pos) {
+                    synced = true;
+                    reuseFrom = k + 1;
+                    break;
+                }
+            }
+        } catch (...) {
+            ast = p.releasePool();
+            throw;
+        }
+        size_t stop = p.position();
+        ast = p.releasePool();
+        if (!synced && stop != levelEnd) return false;
+
+        // o primeiro statement reaproveitado tem de ter o mesmo conteúdo
+        if (reuseFrom < recs.size() && ast.kind(recs[reuseFrom].node) != NodeKind::Block) {
+            const StatementRecord& r = recs[reuseFrom];
+            size_t f = static_cast<size_t>(static_cast<ptrdiff_t>(r.first) + w.tokens);
+            size_t e = static_cast<size_t>(static_cast<ptrdiff_t>(r.end) + w.tokens);
+            if (hashTokens(tokens, f, e) != r.hash) return false;
+        }
+
+        lowerAst(ast, nodeMark);
+        std::vector<StatementRecord> fresh;
+        buildRecords(spans, depth, fresh);
+        for (size_t j = i0; j < reuseFrom; ++j) liveNodes -= recs[j].liveNodes;
+        for (const auto& rec : fresh) liveNodes += rec.liveNodes;
+        if (!isIdentity(w)) {
+            for (size_t j = reuseFrom; j < recs.size(); ++j) shiftRecord(recs[j], w);
+        }
+        reparsed += fresh.size();
+
+        if (fresh.size() == reuseFrom - i0) {           // mesma quantidade: troca no lugar
+            for (size_t j = 0; j < fresh.size(); ++j) {
+                ast.setChild(listNode, i0 + j, fresh[j].node);
+                recs[i0 + j] = std::move(fresh[j]);
+            }
+            return true;
+        }
+        recs.erase(recs.begin() + static_cast<ptrdiff_t>(i0), recs.begin() + static_cast<ptrdiff_t>(reuseFrom));
+        recs.insert(recs.begin() + static_cast<ptrdiff_t>(i0),
+                    std::make_move_iterator(fresh.begin()), std::make_move_iterator(fresh.end()));
+
+        std::vector<NodeId> kids;
+        kids.reserve(recs.size());
+        for (const auto& rec : recs) kids.push_back(rec.node);
+        ast.setChildren(listNode, kids.data(), kids.size());
+        return true;
+    }
+};
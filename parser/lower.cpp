@@ -0,0 +1,92 @@
+// lower.cpp
+// Compiladores - Lowering da AST: decodifica literais e operadores uma vez,
+// logo após o parse, para a semântica e o executor não tocarem em strings
+#include <stdexcept>
+#include <string>
+
+// Operador binário correspondente ao tipo do token
+inline BinaryOp binaryOpFor(TokenType t) {
+    switch (t) {
+        case TokenType::OP_PLUS:    return BinaryOp::Add;
+        case TokenType::OP_MINUS:   return BinaryOp::Sub;
+        case TokenType::OP_STAR:    return BinaryOp::Mul;
+        case TokenType::OP_SLASH:   return BinaryOp::Div;
+        case TokenType::OP_PERCENT: return BinaryOp::Mod;
+        case TokenType::OP_EQ:      return BinaryOp::Eq;
+        case TokenType::OP_NE:      return BinaryOp::Ne;
+        case TokenType::OP_LT:      return BinaryOp::Lt;
+        case TokenType::OP_LE:      return BinaryOp::Le;
+        case TokenType::OP_GT:      return BinaryOp::Gt;
+        case TokenType::OP_GE:      return BinaryOp::Ge;
+        case TokenType::OP_AND:     return BinaryOp::And;
+        case TokenType::OP_OR:      return BinaryOp::Or;
+        default:                    return BinaryOp::None;
+    }
+}
+
+// Texto do operador (para mensagens)
+inline const char* binaryOpSymbol(BinaryOp op) {
+    switch (op) {
+        case BinaryOp::Add: return "+";
+        case BinaryOp::Sub: return "-";
+        case BinaryOp::Mul: return "*";
+        case BinaryOp::Div: return "/";
+        case BinaryOp::Mod: return "%";
+        case BinaryOp::Eq:  return "==";
+        case BinaryOp::Ne:  return "!=";
+        case BinaryOp::Lt:  return "<";
+        case BinaryOp::Le:  return "<=";
+        case BinaryOp::Gt:  return ">";
+        case BinaryOp::Ge:  return ">=";
+        case BinaryOp::And: return "&&";
+        case BinaryOp::Or:  return "||";
+        default:            return "?";
+    }
+}
+
+// Decodifica o valor de um token literal. Um número fora do intervalo não
+// é erro aqui: o executor acusa só se o literal for avaliado.
+inline LiteralValue decodeLiteral(const Token& tok) {
+    LiteralValue v;
+    try {
+        switch (tok.tipo) {
+            case TokenType::NUM_INT:
+                v.type = TypeKind::INT;
+                v.i = std::stoi(std::string(tok.texto));
+                break;
+            case TokenType::NUM_REAL:
+                v.type = TypeKind::REAL;
+                v.d = std::stod(std::string(tok.texto));
+                break;
+            case TokenType::STRING:
+                v.type = TypeKind::STRING;
+                v.s = tok.texto;
+                break;
+            case TokenType::KW_TRUE:
+            case TokenType::KW_FALSE:
+                v.type = TypeKind::BOOL;
+                v.b = (tok.tipo == TokenType::KW_TRUE);
+                break;
+            default:
+                break;
+        }
+    } catch (const std::out_of_range&) {
+        v.outOfRange = true;
+    }
+    return v;
+}
+
+// Lowering de um nó: operador em Binary, valor em Literal
+inline void lowerNode(AstPool& ast, NodeId id) {
+    switch (ast.kind(id)) {
+        case NodeKind::Binary:  ast.setOp(id, binaryOpFor(ast.token(id).tipo)); break;
+        case NodeKind::Literal: ast.setLiteral(id, decodeLiteral(ast.token(id))); break;
+        default: break;
+    }
+}
+
+// Percorre o pool uma vez (só os nós a partir de `from`, quando o pool já
+// foi baixado antes)
+inline void lowerAst(AstPool& ast, NodeId from = 0) {
+    for (NodeId id = from; id < ast.size(); ++id) lowerNode(ast, id);
+}
@@ -0,0 +1,101 @@
+// parallel.cpp
+// Compiladores - Parse paralelo dos statements de topo
+#include <string_view>
+#include <vector>
+
+// Abaixo destes tamanhos não vale a pena dividir o fluxo de tokens
+constexpr size_t PARALLEL_PARSE_MIN_TOKENS = size_t(1) << 16;
+constexpr size_t PARALLEL_PARSE_MIN_CHUNK = size_t(1) << 14;
+
+// Índices de tokens onde começa um statement de topo, um logo depois de
+// cada alvo (`wanted` pedaços do mesmo tamanho). Um statement de topo
+// termina num ';' ou '}' fora de chaves que não seja seguido de 'else'.
+// O primeiro índice é 0 e o último é o do EOF.
+inline vector<size_t> splitTopLevel(const vector<Token>& tokens, size_t wanted) {
+    size_t eof = tokens.size() - 1;
+    vector<size_t> bounds = {0};
+    size_t target = eof / wanted;
+    long depth = 0;
+    for (size_t k = 0; k < eof && bounds.size() < wanted; ++k) {
+        TokenType t = tokens[k].tipo;
+        if (t == TokenType::LBRACE) { depth++; continue; }
+        if (t == TokenType::RBRACE) depth--;
+        else if (t != TokenType::SEMICOLON) continue;
+        if (depth != 0 || k + 1 < target) continue;
+
+        size_t next = k + 1;                        // o 'else' pode vir depois de comentários
+        while (next < eof && tokens[next].tipo == TokenType::COMMENT) next++;
+        if (tokens[next].tipo == TokenType::KW_ELSE || next == eof) continue;
+        bounds.push_back(k + 1);
+        target = eof / wanted * bounds.size();
+    }
+    bounds.push_back(eof);
+    return bounds;
+}
+
+// Parseia um vetor de tokens já pronto dividindo os statements de topo em
+// pedaços parseados no pool; as subárvores são concatenadas em ordem sob o
+// nó program. O resultado é idêntico ao de Parser::parse(). Se algum
+// pedaço falha (erro de sintaxe ou fronteira que não era de statement), o
+// programa é parseado de novo em sequência, que lança o mesmo erro que
+// lançaria sem a divisão.
+inline AstPool parseParallel(const vector<Token>& tokens, ThreadPool& pool,
+                             size_t minChunk = PARALLEL_PARSE_MIN_CHUNK) {
+    size_t wanted = max<size_t>(1, min(pool.size() * 4, tokens.size() / max<size_t>(minChunk, 1)));
+    vector<size_t> bounds = splitTopLevel(tokens, wanted);
+    if (bounds.size() <= 2) return Parser(tokens).parse();
+
+    size_t chunks = bounds.size() - 1;
+    vector<AstPool> parts(chunks);
+    vector<vector<NodeId>> roots(chunks);           // statements de topo de cada pedaço
+    vector<uint8_t> failed(chunks, 0);
+    pool.parallelFor(chunks, [&](size_t c) {
+        try {
+            Parser p(tokens, bounds[c], AstPool());
+            while (p.position() < bounds[c + 1]) {
+                NodeId stmt = p.parseListItem(0);
+                if (stmt == NO_NODE) break;
+                roots[c].push_back(stmt);
+            }
+            if (p.position() != bounds[c + 1]) { failed[c] = 1; return; }
+            parts[c] = p.releasePool();
+            lowerAst(parts[c]);
+        } catch (const exception&) {
+            failed[c] = 1;
+        }
+    });
+    for (uint8_t f : failed) {
+        if (f) return Parser(tokens).parse();
+    }
+
+    // ids dos statements no pool concatenado
+    vector<NodeId> kids;
+    for (size_t c = 0; c < chunks; ++c) {
+        NodeId base = 0;
+        for (size_t d = 0; d < c; ++d) base += static_cast<NodeId>(parts[d].size());
+        for (NodeId r : roots[c]) kids.push_back(base + r);
+    }
+    AstPool ast = AstPool::concat(parts, pool);
+    const Token& last = tokens.size() >= 2 ? tokens[tokens.size() - 2] : tokens.back();
+    ast.root = ast.add(NodeKind::Program, ast.addToken(last), kids.data(), kids.size());
+    return ast;
+}
+
+// Arquivos grandes, com mais de uma thread, vão pelo caminho paralelo
+inline bool useParallelParse(string_view text) {
+    return text.size() >= PARALLEL_LEX_MIN_BYTES && defaultThreadCount() > 1;
+}
+
+// Parseia o texto inteiro (já com lowering). Arquivos grandes são
+// tokenizados e parseados em paralelo; os demais passam pelo Parser em
+// fluxo, sem materializar os tokens.
+inline AstPool parseSource(string_view text, Interner& symbols) {
+    if (useParallelParse(text)) {
+        vector<Token> tokens = tokenizeParallel(text, defaultThreadPool(), symbols);
+        if (tokens.size() >= PARALLEL_PARSE_MIN_TOKENS) return parseParallel(tokens, defaultThreadPool());
+        return Parser(tokens).parse();
+    }
+    Lexer lexer(text, &symbols);
+    Parser parser(lexer);
+    return parser.parse();
+}
@@ -3,379 +3,476 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <unordered_map>
-#include <memory>
 #include <stdexcept>
 #include "../lexer/lexer.cpp"
+#include "ast.cpp"
+#include "lower.cpp"
 
 using namespace std;
 
-// Tipos de nós da AST
-enum class NodeKind {
-    Program,
-    Block,
-    Decl,
-    Assign,
-    If,
-    Binary,
-    Literal,
-    Identifier
-};
-
-// Nó da AST
-struct ASTNode {
-    NodeKind kind;
-    Token token;                       // token principal (op, id ou literal)
-    vector<shared_ptr<ASTNode>> children;
-    string value;                      // lexema ou valor útil
-};
-
-// Erros semânticos simples coletados pelo parser (declaração/uso)
-struct ParserSemanticError {
-    string message;
+// Erro sintático registrado no modo de recuperação
+struct SyntaxError {
+    string message;                     // mensagem + lexema encontrado
     int linha;
     int coluna;
 };
 
-// Contexto semântico simples do parser
-class ParserSemanticContext {
-public:
-    unordered_map<string, string> symbols; // escopo global simples: nome -> tipo
-    vector<ParserSemanticError> errors;
-
-    // Declara uma variável
-    void declare(const string& name, const string& type, int linha, int coluna) {
-        symbols[name] = type;
-    }
+// Resultado de parseWithRecovery: AST parcial (só os statements que
+// parsearam) e todos os erros sintáticos, na ordem do fonte
+struct ParseResult {
+    AstPool ast;
+    vector<SyntaxError> errors;
+};
 
-    // Verifica se uma variável foi declarada
-    bool isDeclared(const string& name) const {
-        return symbols.find(name) != symbols.end();
-    }
+// Ganchos chamados pelo parser à medida que os nós ficam prontos, para a
+// semântica rodar junto com o parse (front end fundido, ver semantic.cpp).
+// Com ganchos, o parser faz o lowering de cada nó ao criá-lo e não usa a
+// própria tabela de declarações. Os ganchos que recebem o pool podem
+// anotar os nós (resolução de nomes). Só valem para parse().
+class ParseHooks {
+public:
+    virtual ~ParseHooks() = default;
+    virtual void declared(const Token& typeTok, const Token& idTok) = 0;   // antes do inicializador
+    virtual void declEnd(AstPool& ast, NodeId decl) = 0;
+    virtual void assignTarget(const Token& idTok) = 0;                     // antes da expressão
+    virtual void assignEnd(AstPool& ast, NodeId assign) = 0;
+    virtual void condition(const AstPool& ast, NodeId cond) = 0;           // condição do if pronta
+    virtual void leaf(AstPool& ast, NodeId node) = 0;                      // literal ou identificador
+    virtual void binary(AstPool& ast, NodeId node) = 0;                    // após os dois operandos
+    virtual void blockBegin(const Token& lbrace) = 0;                      // após o '{'
+    virtual void blockEnd(AstPool& ast, NodeId block) = 0;
+};
 
-    // Registra um erro semântico
-    void report(const string& msg, int linha, int coluna) {
-        errors.push_back({msg, linha, coluna});
-    }
+// Statement de uma lista (programa ou bloco) registrado durante o parse,
+// para o parser incremental: faixa de tokens do fluxo e faixas de tokens e
+// nós que ele ocupa no pool
+struct StatementSpan {
+    uint32_t first, end;                // tokens [first, end) do fluxo
+    NodeId node;
+    uint32_t poolFirst, poolEnd;        // tabela de tokens do pool
+    NodeId nodeFirst, nodeEnd;          // nós criados pelo statement
+    uint32_t depth;                     // 0 = programa, k = dentro de k blocos
 };
 
+// Precedência dos operadores binários (0 = não é operador binário)
+//   || < && < == != < < <= > >= < + - < * / %
+constexpr array<uint8_t, static_cast<size_t>(TokenType::COUNT)> makeBinaryPrecedence() {
+    array<uint8_t, static_cast<size_t>(TokenType::COUNT)> p{};
+    auto set = [&p](TokenType t, uint8_t prec) { p[static_cast<size_t>(t)] = prec; };
+    set(TokenType::OP_OR, 1);
+    set(TokenType::OP_AND, 2);
+    set(TokenType::OP_EQ, 3);      set(TokenType::OP_NE, 3);
+    set(TokenType::OP_LT, 4);      set(TokenType::OP_GT, 4);
+    set(TokenType::OP_LE, 4);      set(TokenType::OP_GE, 4);
+    set(TokenType::OP_PLUS, 5);    set(TokenType::OP_MINUS, 5);
+    set(TokenType::OP_STAR, 6);    set(TokenType::OP_SLASH, 6);
+    set(TokenType::OP_PERCENT, 6);
+    return p;
+}
+
+constexpr auto BINARY_PRECEDENCE = makeBinaryPrecedence();
+
+inline int binaryPrecedence(TokenType t) { return BINARY_PRECEDENCE[static_cast<size_t>(t)]; }
+
 // Analisador Sintático
 class Parser {
 public:
-    Parser(const vector<Token>& tokens) : tokens(tokens), current(0) {}
+    Parser(const vector<Token>& tokens) : stream(tokens) {}
+    // Puxa os tokens do lexer sob demanda, sem materializar o vetor
+    explicit Parser(Lexer& lexer) : stream(lexer) {}
+    // Lê de tokens compactados (linha/coluna calculadas ao materializar)
+    explicit Parser(const PackedTokens& tokens) : stream(tokens) {}
+    // Continua `pool` lendo a partir do token `start` (parser incremental)
+    Parser(const vector<Token>& tokens, size_t start, AstPool pool)
+        : stream(tokens, start), ast(move(pool)) {}
+
+    // Parseia e retorna a AST (a raiz, program, fica em AstPool::root),
+    // já com o lowering aplicado
+    AstPool parse() {
+        ast.root = parseProgram();
+        if (!hooks) lowerAst(ast);     // com ganchos, cada nó já foi baixado
+        return move(ast);
+    }
 
-    // Parseia e retorna a raiz da AST (program)
-    shared_ptr<ASTNode> parse() {
-        return parseProgram();
+    // Liga os ganchos do front end fundido (antes de parse())
+    void setHooks(ParseHooks* h) { hooks = h; }
+
+    // Como parse(), mas sem exceções: cada erro sintático é registrado, o
+    // statement com erro é descartado e a análise continua depois do
+    // próximo ';' ou '}'
+    ParseResult parseWithRecovery() {
+        recovering = true;
+        ParseResult r;
+        ast.root = parseProgram();
+        lowerAst(ast);
+        r.ast = move(ast);
+        r.errors = move(syntaxErrors);
+        return r;
     }
 
-    // Imprime erros semânticos coletados
-    void printSemanticErrors() const {
-        for (auto &e : sem.errors) {
-            cerr << "[Erro semantico] " << e.message
-                 << " (" << e.linha << "," << e.coluna << ")\n";
+    // Registra em `out` cada statement de programa/bloco parseado
+    void recordStatements(vector<StatementSpan>* out) { spans = out; }
+
+    // Próximo statement de uma lista no nível `depth` (0 = programa), sem
+    // lowering; NO_NODE no fim do arquivo ou, dentro de bloco, no '}'.
+    // Segue os laços de parseProgram/parseBlock à risca.
+    NodeId parseListItem(size_t depth) {
+        if (depth == 0) {
+            while (check(TokenType::COMMENT)) advance();
+            if (isAtEnd()) return NO_NODE;
+        } else if (check(TokenType::RBRACE) || isAtEnd()) {
+            return NO_NODE;
         }
+        blockDepth = depth;
+        return parseListed();
     }
 
+    // Índice do token atual no fluxo
+    size_t position() const { return stream.position(); }
+
+    // Devolve o pool (depois de parseListItem)
+    AstPool releasePool() { return move(ast); }
+
 private:
-    const vector<Token>& tokens;
-    size_t current;
-    ParserSemanticContext sem;
+    TokenStream stream;
+    AstPool ast;                       // nós criados até agora
+    vector<NodeId> pending;             // filhos de program/blocos ainda abertos
+    bool recovering = false;            // registrar erros em vez de lançar
+    vector<SyntaxError> syntaxErrors;
+    size_t blockDepth = 0;              // blocos abertos (para a sincronização)
+    vector<StatementSpan>* spans = nullptr;
+    ParseHooks* hooks = nullptr;
+
+    // pilhas do parser de expressões
+    struct PendingOp {
+        uint32_t token;                 // token do operador na tabela do pool
+        uint8_t prec;                   // 0 = marcador de '('
+    };
+    vector<NodeId> operands;
+    vector<PendingOp> operators;
 
     // utilidades
     // Verifica se chegou ao fim dos tokens
     bool isAtEnd() const { return peek().tipo == TokenType::END_OF_FILE; }
 
     // Retorna o token atual sem consumir
-    const Token& peek() const { return tokens.at(current); }
+    const Token& peek() const { return stream.peek(); }
 
     // Retorna o token anterior sem consumir
-    const Token& previous() const { return tokens.at(current - 1); }
+    const Token& previous() const { return stream.previous(); }
 
     // Avança para o próximo token e retorna o atual
     const Token& advance() {
-        if (!isAtEnd()) current++;
+        if (!isAtEnd()) stream.advance();
         return previous();
     }
 
-    // Verifica o tipo do token atual sem consumir
-    bool checkType(TokenType t) const {
-        if (isAtEnd()) return false;
+    // Verifica o tipo do token atual sem consumir (cada operador,
+    // pontuação e palavra-chave tem o seu tipo)
+    bool check(TokenType t) const {
         return peek().tipo == t;
     }
 
-    // Verifica o tipo e texto do token atual sem consumir
-    bool check(TokenType t, const string& text) const {
-        if (isAtEnd()) return false;
-        const Token& tk = peek();
-        return tk.tipo == t && tk.texto == text;
+    // Se o token atual é do tipo, avança e retorna true
+    bool match(TokenType t) {
+        if (check(t)) { advance(); return true; }
+        return false;
     }
 
-    // Se o token atual bate com tipo e texto, avança e retorna true
-    bool match(TokenType t, const string& text) {
-        if (check(t, text)) { advance(); return true; }
+    // Espera que o token atual seja do tipo, avança; senão, erro
+    bool expect(TokenType t, const string& msg) {
+        if (check(t)) { advance(); return true; }
+        error(peek(), msg);
         return false;
     }
 
-    // Espera que o token atual bata com tipo e texto, avança; senão, erro
-    void expect(TokenType t, const string& text, const string& msg) {
-        if (check(t, text)) { advance(); return; }
-        error(peek(), msg);
+    // Erro sintático: lança no modo normal; na recuperação só registra, e
+    // a regra que falhou devolve NO_NODE até o laço de statements
+    void error(const Token& token, const string& msg) {
+        string text = msg + " (encontrei '" + token.lexema() + "')";
+        if (!recovering) {
+            throw runtime_error(
+                "Erro sintatico na linha " + to_string(token.linha) +
+                ", coluna " + to_string(token.coluna) + ": " + text
+            );
+        }
+        syntaxErrors.push_back({move(text), token.linha, token.coluna});
     }
 
-    // Espera que o token atual bata com tipo, avança; senão, erro
-    void expectType(TokenType t, const string& msg) {
-        if (checkType(t)) { advance(); return; }
-        error(peek(), msg);
+    // Descarta tokens até depois do próximo ';' ou até um '}'. O '}' fica
+    // para o bloco aberto fechar; no nível do programa ele é consumido.
+    void synchronize() {
+        while (!isAtEnd()) {
+            if (match(TokenType::SEMICOLON)) return;
+            if (check(TokenType::RBRACE)) {
+                if (blockDepth == 0) advance();
+                return;
+            }
+            advance();
+        }
     }
 
-    // Lança um erro sintático
-    [[noreturn]] void error(const Token& token, const string& msg) {
-        throw runtime_error(
-            "Erro sintatico na linha " + to_string(token.linha) +
-            ", coluna " + to_string(token.coluna) +
-            ": " + msg + " (encontrei '" + token.texto + "')"
-        );
+    // Cria um nó da AST (o token vai para a tabela do pool)
+    NodeId makeNode(NodeKind kind, const Token& tok, const NodeId* kids = nullptr, size_t count = 0) {
+        return ast.add(kind, ast.addToken(tok), kids, count);
     }
 
-    // Cria um nó da AST
-    shared_ptr<ASTNode> makeNode(NodeKind kind, const Token& tok, vector<shared_ptr<ASTNode>> children = {}, const string& value = "") {
-        auto n = make_shared<ASTNode>();
-        n->kind = kind;
-        n->token = tok;
-        n->children = move(children);
-        n->value = value.empty() ? tok.texto : value;
+    // Cria um nó com os filhos empilhados em `pending` a partir de `mark`
+    NodeId makeList(NodeKind kind, const Token& tok, size_t mark) {
+        NodeId n = makeNode(kind, tok, pending.data() + mark, pending.size() - mark);
+        pending.resize(mark);
         return n;
     }
 
-    // Cria um nó binário da AST
-    shared_ptr<ASTNode> makeBinary(const Token& op, shared_ptr<ASTNode> lhs, shared_ptr<ASTNode> rhs) {
-        return makeNode(NodeKind::Binary, op, {lhs, rhs}, op.texto);
-    }
 
     // ===== regras =====
     // program -> stmt*
     // Retorna o nó raiz da AST
-    shared_ptr<ASTNode> parseProgram() {
-        vector<shared_ptr<ASTNode>> stmts;
+    NodeId parseProgram() {
+        size_t mark = pending.size();
         while (!isAtEnd()) {
-            if (checkType(TokenType::COMMENT)) { advance(); continue; }
-            stmts.push_back(parseStatement());
+            if (check(TokenType::COMMENT)) { advance(); continue; }
+            NodeId stmt = parseListed();
+            if (stmt == NO_NODE) { synchronize(); continue; }
+            pending.push_back(stmt);
         }
         Token fake = isAtEnd() ? previous() : peek();
-        return makeNode(NodeKind::Program, fake, move(stmts), "program");
+        return makeList(NodeKind::Program, fake, mark);
+    }
+
+    // Statement filho direto de program/bloco, registrado em `spans`
+    NodeId parseListed() {
+        while (check(TokenType::COMMENT)) advance();    // o mesmo que parseStatement faria
+        if (!spans) return parseStatement();
+        uint32_t first = static_cast<uint32_t>(position());
+        uint32_t poolFirst = static_cast<uint32_t>(ast.tokenCount());
+        NodeId nodeFirst = static_cast<NodeId>(ast.size());
+        uint32_t depth = static_cast<uint32_t>(blockDepth);
+        NodeId stmt = parseStatement();
+        if (stmt != NO_NODE) {
+            spans->push_back({first, static_cast<uint32_t>(position()), stmt,
+                              poolFirst, static_cast<uint32_t>(ast.tokenCount()),
+                              nodeFirst, static_cast<NodeId>(ast.size()), depth});
+        }
+        return stmt;
     }
 
     // stmt -> decl | ifStmt | assign | block
     // Declaração, if, atribuição ou bloco
-    shared_ptr<ASTNode> parseStatement() {
-        while (checkType(TokenType::COMMENT)) advance();    // pular comentários
+    NodeId parseStatement() {
+        while (check(TokenType::COMMENT)) advance();    // pular comentários
 
-        if (checkType(TokenType::KEYWORD) && isTypeKeyword(peek().texto)) {
+        if (isTypeKeyword(peek().tipo)) {
             return parseDecl();
         }
-        if (check(TokenType::KEYWORD, "if")) {
+        if (check(TokenType::KW_IF)) {
             return parseIf();
         }
-        if (check(TokenType::PUNCTUATION, "{")) {
+        if (check(TokenType::LBRACE)) {
             return parseBlock();
         }
-        if (checkType(TokenType::IDENTIFIER)) {
+        if (check(TokenType::IDENTIFIER)) {
             return parseAssign();
         }
 
         error(peek(), "declaracao, if, bloco ou atribuicao esperado");
+        return NO_NODE;
     }
 
     // decl -> (int|float|string|bool) IDENTIFIER ( "=" expr )? ";"
     // Declaração de variável com inicialização opcional
-    shared_ptr<ASTNode> parseDecl() {
+    NodeId parseDecl() {
         Token typeTok = advance();              // tipo
-        string typeText = typeTok.texto;
+        string typeText(typeTok.texto);
 
         Token idTok = peek();
-        expectType(TokenType::IDENTIFIER, "identificador esperado apos '" + typeText + "'");
+        if (!expect(TokenType::IDENTIFIER, "identificador esperado apos '" + typeText + "'")) return NO_NODE;
 
-        // registrar tipo na tabela do parser
-        sem.declare(idTok.texto, typeText, idTok.linha, idTok.coluna);
+        // declaração vista pela semântica, se fundida
+        if (hooks) hooks->declared(typeTok, idTok);
 
         // filhos do nó de declaração
-        vector<shared_ptr<ASTNode>> kids;
-        kids.push_back(makeNode(NodeKind::Identifier, idTok));
+        NodeId kids[2];
+        size_t count = 0;
+        kids[count++] = makeNode(NodeKind::Identifier, idTok);
 
         // inicialização opcional
-        if (match(TokenType::OPERATOR, "=")) {
-            auto initExpr = parseExpr();
-            kids.push_back(initExpr);
+        if (match(TokenType::OP_ASSIGN)) {
+            kids[count++] = parseExpr();
+            if (kids[1] == NO_NODE) return NO_NODE;
         }
 
-        expect(TokenType::PUNCTUATION, ";", "';' esperado ao final da declaracao");
-        // valor do nó = nome da variável; token do nó = token do tipo (para semântica saber o tipo)
-        auto declNode = makeNode(NodeKind::Decl, typeTok, move(kids), idTok.texto);
-        return declNode;
+        if (!expect(TokenType::SEMICOLON, "';' esperado ao final da declaracao")) return NO_NODE;
+        // valor do nó = nome da variável (filho 0); token do nó = token do tipo (para semântica saber o tipo)
+        NodeId decl = makeNode(NodeKind::Decl, typeTok, kids, count);
+        if (hooks) hooks->declEnd(ast, decl);
+        return decl;
     }
 
     // block -> "{" stmt* "}"
     // Bloco de código
-    shared_ptr<ASTNode> parseBlock() {  
+    NodeId parseBlock() {  
         Token lbrace = peek();                                          // salvar token '{' para o nó
-        expect(TokenType::PUNCTUATION, "{", "esperado '{' para iniciar bloco");
-        vector<shared_ptr<ASTNode>> stmts;                              // filhos do nó bloco
-        while (!check(TokenType::PUNCTUATION, "}") && !isAtEnd()) {     // enquanto não achar '}' ou EOF
-            stmts.push_back(parseStatement());                          // parsear statements dentro do bloco
+        if (!expect(TokenType::LBRACE, "esperado '{' para iniciar bloco")) return NO_NODE;
+        if (hooks) hooks->blockBegin(lbrace);
+        size_t mark = pending.size();                                   // filhos do nó bloco
+        blockDepth++;
+        while (!check(TokenType::RBRACE) && !isAtEnd()) {               // enquanto não achar '}' ou EOF
+            NodeId stmt = parseListed();                                // parsear statements dentro do bloco
+            if (stmt == NO_NODE) { synchronize(); continue; }           // erro já registrado
+            pending.push_back(stmt);
         }
-        expect(TokenType::PUNCTUATION, "}", "esperado '}' ao final do bloco");
-        return makeNode(NodeKind::Block, lbrace, move(stmts), "block"); // criar nó bloco
+        blockDepth--;
+        expect(TokenType::RBRACE, "esperado '}' ao final do bloco");    // só falha no fim do arquivo
+        NodeId block = makeList(NodeKind::Block, lbrace, mark);         // criar nó bloco
+        if (hooks) hooks->blockEnd(ast, block);
+        return block;
     }
 
     // ifStmt -> "if" "(" expr ")" stmt ("else" stmt)?
     // Instrução condicional if-else
-    shared_ptr<ASTNode> parseIf() {                                     // inicia um if
+    NodeId parseIf() {                                     // inicia um if
         Token ifTok = peek();
-        expect(TokenType::KEYWORD, "if", "esperado 'if'");              // condição do if     
-        expect(TokenType::PUNCTUATION, "(", "esperado '(' apos if");    // abrir parêntese
-        auto cond = parseExpr();                                        // expressão condicional
-        expect(TokenType::PUNCTUATION, ")", "esperado ')' apos condicao do if");    // fechar parêntese
-        auto thenBranch = parseStatement();                             // ramo "then"
-        shared_ptr<ASTNode> elseBranch = nullptr;                       // ramo "else" opcional
-        if (match(TokenType::KEYWORD, "else")) {                        // se houver "else"
-            elseBranch = parseStatement();                              // parsear ramo "else"
+        if (!expect(TokenType::KW_IF, "esperado 'if'")) return NO_NODE;  // condição do if
+        if (!expect(TokenType::LPAREN, "esperado '(' apos if")) return NO_NODE;  // abrir parêntese
+        NodeId kids[3];                                                 // filhos do nó if
+        kids[0] = parseExpr();                                          // expressão condicional
+        if (kids[0] == NO_NODE) return NO_NODE;
+        if (hooks) hooks->condition(ast, kids[0]);
+        if (!expect(TokenType::RPAREN, "esperado ')' apos condicao do if")) return NO_NODE;  // fechar parêntese
+        kids[1] = parseStatement();                                     // ramo "then"
+        if (kids[1] == NO_NODE) return NO_NODE;
+        size_t count = 2;
+        if (match(TokenType::KW_ELSE)) {                                // se houver "else"
+            kids[count++] = parseStatement();                           // ramo "else" opcional
+            if (kids[2] == NO_NODE) return NO_NODE;
         }
-        vector<shared_ptr<ASTNode>> kids = {cond, thenBranch};          // filhos do nó if
-        if (elseBranch) kids.push_back(elseBranch);                     // adicionar ramo else se existir
-        return makeNode(NodeKind::If, ifTok, move(kids), "if");         // criar nó if
+        return makeNode(NodeKind::If, ifTok, kids, count);              // criar nó if
     }
 
     // assign -> IDENTIFIER "=" expr ";"
     // Atribuição de valor a variável
-    shared_ptr<ASTNode> parseAssign() {                                 // inicia uma atribuição
+    NodeId parseAssign() {                                 // inicia uma atribuição
         Token idTok = advance();       
-        if (!sem.isDeclared(idTok.texto)) {                             // verificar se foi declarado
-            sem.report("variavel '" + idTok.texto + "' usada sem declarar", idTok.linha, idTok.coluna);
-        }
-        expect(TokenType::OPERATOR, "=", "esperado '=' na atribuicao");
-        auto expr = parseExpr();                                        // expressão do lado direito
-        expect(TokenType::PUNCTUATION, ";", "esperado ';' ao final da atribuicao");
-        auto idNode = makeNode(NodeKind::Identifier, idTok);            // nó do identificador
-        return makeNode(NodeKind::Assign, idTok, {idNode, expr}, "=");  // nó de atribuição
+        if (hooks) hooks->assignTarget(idTok);
+        if (!expect(TokenType::OP_ASSIGN, "esperado '=' na atribuicao")) return NO_NODE;
+        NodeId expr = parseExpr();                                      // expressão do lado direito
+        if (expr == NO_NODE) return NO_NODE;
+        if (!expect(TokenType::SEMICOLON, "esperado ';' ao final da atribuicao")) return NO_NODE;
+        uint32_t tok = ast.addToken(idTok);                             // o nó e o identificador dividem o token
+        NodeId kids[2] = {ast.add(NodeKind::Identifier, tok), expr};    // nó do identificador
+        NodeId assign = ast.add(NodeKind::Assign, tok, kids, 2);        // nó de atribuição
+        if (hooks) hooks->assignEnd(ast, assign);
+        return assign;
     }
 
     // ===== EXPRESSÕES =====
-    
-    shared_ptr<ASTNode> parseExpr() { return parseOr(); }   // expressão lógica OR
-
-    // orExpr -> andExpr ( "||" andExpr )*
-    shared_ptr<ASTNode> parseOr() { 
-        auto left = parseAnd();                         // expressão lógica AND
-        while (match(TokenType::OPERATOR, "||")) {      // enquanto achar "||"
-            Token op = previous();                      // operador ||
-            auto right = parseAnd();                    // próxima expressão AND
-            left = makeBinary(op, left, right);         // criar nó binário
-        }
-        return left;                                    // retornar expressão resultante
-    }
 
-    // andExpr -> equality ( "&&" equality )*
-    // expressão lógica AND
-    shared_ptr<ASTNode> parseAnd() {
-        auto left = parseEquality();                    // expressão de igualdade
-        while (match(TokenType::OPERATOR, "&&")) {      // enquanto achar "&&"
-            Token op = previous();                      // operador &&
-            auto right = parseEquality();               // próxima expressão de igualdade
-            left = makeBinary(op, left, right);         // criar nó binário
-        }
-        return left;                                    // retornar expressão resultante
-    }
+    // expr -> operand ( binop operand )*
+    // operand -> IDENTIFIER | NUM_INT | NUM_REAL | STRING | BOOL | "(" expr ")"
+    // Precedence climbing com pilhas explícitas de operandos e operadores:
+    // um operador que chega reduz os de precedência maior ou igual (todos
+    // associam à esquerda) e '(' entra na pilha como marcador. Cada token
+    // custa O(1) amortizado e o aninhamento não usa a pilha de chamadas.
+    NodeId parseExpr() {
+        size_t operatorBase = operators.size();
+        size_t operandBase = operands.size();
+        size_t openParens = 0;
+        while (true) {
+            while (match(TokenType::LPAREN)) {          // '(' antes do operando
+                operators.push_back({0, 0});            // marcador (precedência 0)
+                openParens++;
+            }
+            NodeId operand = parseOperand();
+            if (operand == NO_NODE) {                   // erro já registrado: limpa as pilhas
+                operators.resize(operatorBase);
+                operands.resize(operandBase);
+                return NO_NODE;
+            }
+            operands.push_back(operand);
 
-    // equality -> rel (("=="|"!=") rel)*
-    // expressão de igualdade
-    shared_ptr<ASTNode> parseEquality() {
-        auto left = parseRel();                         // expressão relacional
-        while (check(TokenType::OPERATOR, "==") || check(TokenType::OPERATOR, "!=")) {  // enquanto achar "==" ou "!="
-            Token op = advance();
-            auto right = parseRel();                    // próxima expressão relacional
-            left = makeBinary(op, left, right);         // criar nó binário
-        }
-        return left;
-    }
+            while (openParens > 0 && check(TokenType::RPAREN)) {    // ')' fecha o marcador mais recente
+                reduce(operatorBase, 1);
+                operators.pop_back();
+                openParens--;
+                advance();
+            }
 
-    // rel -> add (("<"|">"|"<="|">=") add)*
-    // expressão relacional
-    shared_ptr<ASTNode> parseRel() {                    // expressão relacional
-        auto left = parseAdd();                         // expressão de adição
-        while (check(TokenType::OPERATOR, "<") ||
-               check(TokenType::OPERATOR, ">") ||
-               check(TokenType::OPERATOR, "<=") ||
-               check(TokenType::OPERATOR, ">=")) {
-            Token op = advance();
-            auto right = parseAdd();                    // próxima expressão de adição
-            left = makeBinary(op, left, right);         // criar nó binário
+            int prec = binaryPrecedence(peek().tipo);
+            if (prec == 0) break;                       // fim da expressão
+            reduce(operatorBase, prec);
+            operators.push_back({ast.addToken(advance()), static_cast<uint8_t>(prec)});
         }
-        return left;
-    }
-
-    // add -> mult (("+"|"-") mult)*
-    // expressão de adição
-    shared_ptr<ASTNode> parseAdd() {                    // expressão de adição
-        auto left = parseMult();                        // expressão de multiplicação
-        while (check(TokenType::OPERATOR, "+") || check(TokenType::OPERATOR, "-")) {    // enquanto achar "+" ou "-"
-            Token op = advance();                       // operador + ou -    
-            auto right = parseMult();                   // próxima expressão de multiplicação
-            left = makeBinary(op, left, right);         // criar nó binário
+        if (openParens > 0 && !expect(TokenType::RPAREN, "esperado ')' apos expressao")) {
+            operators.resize(operatorBase);
+            operands.resize(operandBase);
+            return NO_NODE;
         }
-        return left;
+        reduce(operatorBase, 1);
+        NodeId expr = operands.back();
+        operands.pop_back();
+        return expr;
     }
 
-    // mult -> primary (("*"|"/"|"%") primary)*
-    // expressão de multiplicação
-    shared_ptr<ASTNode> parseMult() {                   // expressão de multiplicação
-        auto left = parsePrimary();                     // expressão primária    
-        while (check(TokenType::OPERATOR, "*") ||
-               check(TokenType::OPERATOR, "/") ||
-               check(TokenType::OPERATOR, "%")) {
-            Token op = advance();                       // operador * / %
-            auto right = parsePrimary();                // próxima expressão primária
-            left = makeBinary(op, left, right);         // criar nó binário
+    // Desempilha operadores com precedência >= minPrec (sem passar de um
+    // marcador de '(' nem de `floor`) criando os nós binários
+    void reduce(size_t floor, int minPrec) {
+        while (operators.size() > floor && operators.back().prec >= minPrec) {
+            PendingOp op = operators.back();
+            operators.pop_back();
+            NodeId rhs = operands.back();
+            operands.pop_back();
+            NodeId kids[2] = {operands.back(), rhs};
+            operands.back() = ast.add(NodeKind::Binary, op.token, kids, 2);
+            if (hooks) {
+                lowerNode(ast, operands.back());
+                hooks->binary(ast, operands.back());
+            }
         }
-        return left;
     }
 
-    // primary -> IDENTIFIER | NUM_INT | NUM_REAL | STRING | BOOL | "(" expr ")"
-    // expressão primária: identificador, literal ou parêntese
-    shared_ptr<ASTNode> parsePrimary() {                // expressão primária
-        if (checkType(TokenType::IDENTIFIER)) {         // identificador
+    // operando: identificador ou literal
+    NodeId parseOperand() {
+        if (check(TokenType::IDENTIFIER)) {             // identificador
             Token id = advance();                       // consumir identificador
-            if (!sem.isDeclared(id.texto)) {            // verificar se foi declarado
-                sem.report("variavel '" + id.texto + "' usada sem declarar", id.linha, id.coluna);
-            }
-            return makeNode(NodeKind::Identifier, id);  // criar nó identificador
+            return makeLeaf(NodeKind::Identifier, id);  // criar nó identificador
         }
 
         // se for literal
-        if (checkType(TokenType::NUM_INT) || checkType(TokenType::NUM_REAL) || checkType(TokenType::STRING)) {
+        if (check(TokenType::NUM_INT) || check(TokenType::NUM_REAL) || check(TokenType::STRING)) {
             Token lit = advance();
-            return makeNode(NodeKind::Literal, lit);
+            return makeLeaf(NodeKind::Literal, lit);
         }
 
         // se for booleano
-        if (check(TokenType::KEYWORD, "true") || check(TokenType::KEYWORD, "false")) {
+        if (check(TokenType::KW_TRUE) || check(TokenType::KW_FALSE)) {
             Token lit = advance();
-            return makeNode(NodeKind::Literal, lit);
-        }
-
-        // se for parêntese
-        if (match(TokenType::PUNCTUATION, "(")) {
-            auto expr = parseExpr();
-            expect(TokenType::PUNCTUATION, ")", "esperado ')' apos expressao");
-            return expr;
+            return makeLeaf(NodeKind::Literal, lit);
         }
 
         // se nada bater, erro
         error(peek(), "expressao, identificador ou literal esperado");
+        return NO_NODE;
+    }
+
+    // Folha de expressão; com ganchos, já baixada e avisada
+    NodeId makeLeaf(NodeKind kind, const Token& tok) {
+        NodeId n = makeNode(kind, tok);
+        if (hooks) {
+            lowerNode(ast, n);
+            hooks->leaf(ast, n);
+        }
+        return n;
     }
 
     // Verifica se uma palavra-chave é um tipo válido
-    bool isTypeKeyword(const string& kw) const {
-        return kw == "int" || kw == "float" || kw == "string" || kw == "bool" || kw == "boolean";
+    bool isTypeKeyword(TokenType t) const {
+        return t == TokenType::KW_INT || t == TokenType::KW_FLOAT ||
+               t == TokenType::KW_STRING || t == TokenType::KW_BOOLEAN;
     }
 };
+
+// dependem de Parser
+#include "incremental.cpp"
+#include "parallel.cpp"
+#include "astbin.cpp"
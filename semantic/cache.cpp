@@ -0,0 +1,170 @@
+// cache.cpp
+// Compiladores - Cache em disco do front end: a AST checada de cada fonte
+// é guardada como imagem binária (parser/astbin.cpp), chaveada pelo hash
+// do conteúdo, e execuções seguintes do mesmo fonte pulam lexer, parser e
+// semântica
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+// Versão do front end: aumentar sempre que parser, semântica ou passes
+// mudarem a AST que vai para o cache
+constexpr uint32_t FRONT_END_VERSION = 1;
+
+// Identificação do compilador gravada nas entradas: uma entrada de outra
+// versão do front end ou do formato é tratada como velha. Não depende da
+// hora do build, então recompilar o mesmo código mantém o cache.
+inline uint64_t compilerId() {
+    return static_cast<uint64_t>(FRONT_END_VERSION) << 32 | AST_BIN_VERSION;
+}
+
+// Resultado semântico de uma imagem: os nós já estão resolvidos, então
+// só os nomes dos slots do programa são lidos; sem erros
+inline SemanticResult semanticFromImage(const AstBinary& image) {
+    SemanticResult res;
+    res.symbols.globals.reserve(image.globalCount());
+    for (size_t k = 0; k < image.globalCount(); ++k) res.symbols.globals.push_back(image.globalSymbol(k));
+    return res;
+}
+
+// Passes de `passes` (opt/passes.cpp) sobre a AST checada e sem erros,
+// antes de ela ir para o cache ou para uma imagem; com `stats`, as medidas
+// de cada passe
+inline void optimizeFrontEnd(FrontEndResult& front, const PassManager& passes, std::vector<PassStats>* stats = nullptr) {
+    if (!front.sem.errors.empty()) return;
+    passes.run(front.ast, stats);
+}
+
+// Imagem de um front end sem erros
+inline std::string serializeFrontEnd(const FrontEndResult& front, const Interner& symbols,
+                                     const AstBinKey& key = {}) {
+    return serializeAst(front.ast, symbols, front.sem.symbols.globals, key);
+}
+
+// Diretório de entradas `<hash do fonte>-O<nível>.astb`. Cada entrada guarda
+// a própria chave (hash e tamanho do fonte, compilerId, nível) e um checksum;
+// entradas velhas ou corrompidas contam como falta e são regravadas. O
+// cache é só uma otimização: falhas de leitura ou gravação são ignoradas.
+class FrontEndCache {
+public:
+    explicit FrontEndCache(std::string directory) : dir(std::move(directory)) {}
+
+    // Diretório de --cache-dir ou, sem a opção, de MICROCOMPILADOR_CACHE
+    static std::string defaultDirectory() {
+        const char* env = std::getenv("MICROCOMPILADOR_CACHE");
+        return env ? env : "";
+    }
+
+    static AstBinKey keyFor(std::string_view source, unsigned optLevel = 0) {
+        return {hashBytes(source), source.size(), compilerId(), optLevel};
+    }
+
+    // Imagem da entrada de `key`, se existir e estiver íntegra e atual
+    bool lookup(const AstBinKey& key, AstBinary& out) const {
+        std::error_code ec;
+        std::string path = entryPath(key);
+        if (!std::filesystem::is_regular_file(path, ec)) return false;
+        try {
+            AstBinary image = loadAstBinary(path, true);
+            const AstBinKey& k = image.key();
+            if (k.sourceHash != key.sourceHash || k.sourceSize != key.sourceSize ||
+                k.compilerId != key.compilerId || k.optLevel != key.optLevel) {
+                return false;                       // velha: outro build ou colisão
+            }
+            out = std::move(image);
+            return true;
+        } catch (const std::exception&) {
+            return false;                           // truncada, corrompida ou de outra versão
+        }
+    }
+
+    // Grava a entrada num arquivo temporário e o renomeia, para um leitor
+    // concorrente nunca ver uma entrada pela metade
+    void store(const AstBinKey& key, const std::string& image) const {
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        std::string path = entryPath(key);
+        std::string tmp = path + ".tmp" + std::to_string(std::random_device{}());
+        try {
+            writeAstBinary(tmp, image);
+        } catch (const std::exception&) {
+            std::filesystem::remove(tmp, ec);
+            return;
+        }
+        std::filesystem::rename(tmp, path, ec);
+        if (ec) std::filesystem::remove(tmp, ec);
+    }
+
+private:
+    std::string dir;
+
+    std::string entryPath(const AstBinKey& key) const {
+        char name[40];
+        std::snprintf(name, sizeof(name), "%016llx-O%llu.astb", static_cast<unsigned long long>(key.sourceHash),
+                      static_cast<unsigned long long>(key.optLevel));
+        return (std::filesystem::path(dir) / name).string();
+    }
+};
+
+// Programa pronto para --ast/--run: vindo do fonte ou de uma imagem
+// (passada direto ou achada no cache). Guarda o que os tokens e o pool
+// referenciam, e os nomes saem do Interner ou da imagem.
+struct LoadedProgram {
+    std::shared_ptr<SourceBuffer> input;
+    Interner symbols;
+    AstBinary image;
+    FrontEndResult front;
+    bool fromImage = false;
+
+    std::string_view name(SymbolId id) const { return fromImage ? image.name(id) : symbols.name(id); }
+
+    void useImage(AstBinary img) {
+        image = std::move(img);
+        front.ast = image.ast;
+        front.sem = semanticFromImage(image);
+        fromImage = true;
+    }
+};
+
+// Carrega `filename`: uma imagem de --emit-ast-bin é usada direto, como foi
+// gravada; um fonte passa pelo cache, se houver, e só é analisado (e
+// otimizado no nível `optLevel`) numa falta. Só fontes sem erros semânticos
+// entram no cache, uma entrada por nível. Com `passes` (lista de --passes),
+// roda essa lista no lugar da do nível e não usa o cache, que só conhece
+// níveis. Com `stats` (--pass-stats) o cache também fica de fora, para os
+// passes rodarem e serem medidos; só uma imagem passada direto chega sem
+// medidas.
+inline LoadedProgram loadProgram(const std::string& filename, const FrontEndCache* cache, unsigned optLevel = 0,
+                                 std::vector<PassStats>* stats = nullptr, const PassManager* passes = nullptr) {
+    PassManager pipeline = passes ? *passes : PassManager::forLevel(optLevel);
+    LoadedProgram p;
+    p.input = SourceBuffer::fromFile(filename);
+    std::string_view text = p.input->text();
+    if (AstBinary::isImage(text)) {
+        p.useImage(AstBinary::load(p.input, true));   // imagem avulsa: conteúdo conferido
+        return p;
+    }
+    if (!cache || passes || stats) {
+        p.front = analyzeSource(text, p.symbols);
+        optimizeFrontEnd(p.front, pipeline, stats);
+        return p;
+    }
+
+    AstBinKey key = FrontEndCache::keyFor(text, optLevel);
+    AstBinary hit;
+    if (cache->lookup(key, hit)) {
+        p.useImage(std::move(hit));
+        return p;
+    }
+    p.front = analyzeSource(text, p.symbols);
+    optimizeFrontEnd(p.front, pipeline, stats);
+    if (p.front.sem.errors.empty()) cache->store(key, serializeFrontEnd(p.front, p.symbols, key));
+    return p;
+}
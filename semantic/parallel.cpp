@@ -0,0 +1,129 @@
+// parallel.cpp
+// Compiladores - Checagem semântica em duas fases para programas grandes:
+// uma passada sequencial só pelos statements (escopos, declarações, slots)
+// e a checagem das expressões, que é a maior parte do trabalho, num pool
+// de threads. Os erros saem na mesma ordem de checkProgram().
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+// Expressão de um statement a checar na segunda fase. `when` é o instante
+// da tabela de símbolos em que a passada sequencial a avaliaria; `errors`
+// começa com os erros da primeira fase no mesmo statement.
+struct CheckJob {
+    NodeId node;                           // Decl, Assign, If ou Block
+    Binding binding;                       // Decl: variável; Assign: alvo
+    uint32_t when;
+    std::vector<SemanticError> errors;
+};
+
+// Primeira fase: as mesmas regras de checkNode para tudo que não é
+// expressão, deixando um CheckJob por statement na ordem do percurso
+static void collectJobs(AstPool& ast, NodeId node, SemanticResult& ctx, std::vector<CheckJob>& jobs) {
+    if (node == NO_NODE) return;
+
+    switch (ast.kind(node)) {
+        case NodeKind::Program:
+            for (size_t i = 0; i < ast.childCount(node); ++i) collectJobs(ast, ast.child(node, i), ctx, jobs);
+            ast.setFrameSize(node, ctx.symbols.scopeSlots());
+            break;
+
+        // bloco: só gera job se o aninhamento estourar
+        case NodeKind::Block: {
+            size_t before = ctx.errors.size();
+            enterBlock(ast.token(node), ctx);
+            if (ctx.errors.size() > before) {
+                jobs.push_back({node, {}, ctx.symbols.now(), std::move(ctx.errors)});
+                ctx.errors.clear();
+            }
+            for (size_t i = 0; i < ast.childCount(node); ++i) collectJobs(ast, ast.child(node, i), ctx, jobs);
+            ast.setFrameSize(node, ctx.symbols.exitScope());
+            break;
+        }
+
+        case NodeKind::Decl: {
+            Binding var = declareVariable(ast.token(node), ast.token(ast.child(node, 0)), ctx);
+            ast.setSlot(ast.child(node, 0), var.depth, var.slot, var.type);
+            jobs.push_back({node, var, ctx.symbols.now(), std::move(ctx.errors)});
+            ctx.errors.clear();
+            break;
+        }
+
+        case NodeKind::Assign: {
+            Binding target = assignTarget(ast.token(ast.child(node, 0)), ctx);
+            ast.setSlot(ast.child(node, 0), target.depth, target.slot, target.type);
+            jobs.push_back({node, target, ctx.symbols.now(), std::move(ctx.errors)});
+            ctx.errors.clear();
+            break;
+        }
+
+        case NodeKind::If:
+            jobs.push_back({node, {}, ctx.symbols.now(), {}});
+            for (size_t i = 1; i < ast.childCount(node); ++i) collectJobs(ast, ast.child(node, i), ctx, jobs);
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Nomes resolvidos como estavam no instante do statement
+struct VisibleAt {
+    const SymbolTable& symbols;
+    uint32_t when;
+    const Binding* operator()(SymbolId id) const { return symbols.findAt(id, when); }
+};
+
+// Segunda fase: a expressão de um job. Cada job só escreve nos
+// Identifier da própria expressão, então jobs rodam em paralelo.
+static void checkJob(AstPool& ast, const SymbolTable& symbols, CheckJob& job) {
+    NodeId node = job.node;
+    VisibleAt lookup{symbols, job.when};
+    switch (ast.kind(node)) {
+        case NodeKind::Decl:
+            if (ast.childCount(node) > 1) {
+                TypeKind initType = evalExpr(ast, ast.child(node, 1), lookup, job.errors);
+                checkInit(job.binding.type, initType, ast.token(node), job.errors);
+            }
+            break;
+
+        case NodeKind::Assign: {
+            TypeKind exprType = evalExpr(ast, ast.child(node, 1), lookup, job.errors);
+            checkAssign(job.binding.type, exprType, ast.token(node), job.errors);
+            break;
+        }
+
+        case NodeKind::If:
+            if (ast.childCount(node) > 0) {
+                TypeKind condType = evalExpr(ast, ast.child(node, 0), lookup, job.errors);
+                checkCondition(condType, ast.token(ast.child(node, 0)), job.errors);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Mesmo resultado de checkProgram(): AST anotada igual e erros na mesma
+// ordem, concatenados job a job
+inline SemanticResult checkProgramParallel(AstPool& ast, ThreadPool& pool) {
+    SemanticResult res;
+    std::vector<CheckJob> jobs;
+    collectJobs(ast, ast.root, res, jobs);
+    res.symbols.indexHistory();
+
+    constexpr size_t CHUNK = 1024;                 // jobs por tarefa
+    size_t chunks = (jobs.size() + CHUNK - 1) / CHUNK;
+    pool.parallelFor(chunks, [&](size_t c) {
+        size_t end = std::min(jobs.size(), (c + 1) * CHUNK);
+        for (size_t k = c * CHUNK; k < end; ++k) checkJob(ast, res.symbols, jobs[k]);
+    });
+
+    for (CheckJob& job : jobs) {
+        res.errors.insert(res.errors.end(), std::make_move_iterator(job.errors.begin()),
+                          std::make_move_iterator(job.errors.end()));
+    }
+    if (res.errors.empty()) specializeProgram(ast);
+    return res;
+}
@@ -1,20 +1,11 @@
 // semantic.cpp - checagem semântica básica usando a AST
 // Compiladores - Analisador Semântico
-#include <unordered_map>
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <iostream>
 #include "../parser/parser.cpp"
 
-// Definição dos tipos de dados
-enum class TypeKind {
-    INT,
-    REAL,
-    STRING,
-    BOOL,
-    UNKNOWN
-};
-
 // Estrutura de erro semântico
 struct SemanticError {
     std::string message;
@@ -22,9 +13,121 @@ struct SemanticError {
     int coluna;
 };
 
+// Variável declarada: escopo (profundidade do bloco, 0 = programa), slot
+// no frame desse escopo e tipo
+struct Binding {
+    uint16_t depth;
+    uint32_t slot;
+    TypeKind type;
+};
+
+// Tabela de símbolos com escopos de bloco e sombreamento. Cada declaração
+// ganha o próximo slot do escopo aberto; `visible` leva o id do nome
+// (Token::simbolo) à declaração visível mais interna, e cada entrada
+// lembra a que escondeu, restaurada quando o bloco fecha. O escopo do
+// programa nunca fecha: os nomes dos seus slots ficam em `globals`, que é
+// o que sobra para o estado final do --run.
+//
+// As entradas de escopos já fechados continuam guardadas, com o instante
+// (`now()`) em que foram declaradas e em que o escopo fechou, para que
+// findAt() responda o que estava visível num ponto anterior do programa
+// (checagem paralela, ver semantic/parallel.cpp).
+class SymbolTable {
+public:
+    std::vector<SymbolId> globals;             // slot do programa -> id do nome
+
+    // declaração visível, ou nullptr se a variável não foi declarada
+    const Binding* find(SymbolId id) const {
+        if (id >= visible.size() || visible[id] == NONE) return nullptr;
+        return &entries[visible[id]].binding;
+    }
+
+    // já declarada no escopo aberto (redeclaração, não sombreamento)
+    bool declaredHere(SymbolId id) const {
+        const Binding* b = find(id);
+        return b && b->depth == depth();
+    }
+
+    Binding declare(SymbolId id, TypeKind t) {
+        if (id >= visible.size()) visible.resize(id + 1, NONE);
+        Binding b{depth(), scopeSlots(), t};
+        entries.push_back({b, id, visible[id], clock++, OPEN});
+        visible[id] = static_cast<uint32_t>(entries.size() - 1);
+        open.push_back(visible[id]);
+        if (scopes.size() == 1) globals.push_back(id);
+        return b;
+    }
+
+    void enterScope() { scopes.push_back(static_cast<uint32_t>(open.size())); }
+
+    // Fecha o escopo aberto e devolve quantos slots ele usou
+    uint32_t exitScope() {
+        uint32_t slots = scopeSlots();
+        for (size_t k = open.size(); k-- > scopes.back();) {
+            Entry& e = entries[open[k]];
+            visible[e.name] = e.shadowed;
+            e.scopeEnd = clock;
+        }
+        open.resize(scopes.back());
+        scopes.pop_back();
+        ++clock;
+        return slots;
+    }
+
+    uint32_t scopeSlots() const { return static_cast<uint32_t>(open.size() - scopes.back()); }
+    uint16_t depth() const { return static_cast<uint16_t>(scopes.size() - 1); }
+    size_t openScopes() const { return scopes.size(); }
+
+    // Instante atual: avança a cada declaração e a cada escopo fechado
+    uint32_t now() const { return clock; }
+
+    // Monta o índice por nome usado por findAt(); chamar depois da última
+    // declaração
+    void indexHistory() {
+        byNameStart.assign(visible.size() + 1, 0);
+        for (const Entry& e : entries) ++byNameStart[e.name + 1];
+        for (size_t k = 1; k < byNameStart.size(); ++k) byNameStart[k] += byNameStart[k - 1];
+        byName.resize(entries.size());
+        std::vector<uint32_t> fill(byNameStart.begin(), byNameStart.end() - 1);
+        for (uint32_t k = 0; k < entries.size(); ++k) byName[fill[entries[k].name]++] = k;
+    }
+
+    // Declaração que find() devolveria no instante `when`: a última do nome
+    // antes de `when` ou, se o escopo dela já tinha fechado, a que ela
+    // escondia (e assim por diante)
+    const Binding* findAt(SymbolId id, uint32_t when) const {
+        if (id + 1 >= byNameStart.size()) return nullptr;
+        auto first = byName.begin() + byNameStart[id];
+        auto last = byName.begin() + byNameStart[id + 1];
+        auto it = std::partition_point(first, last, [&](uint32_t k) { return entries[k].order < when; });
+        if (it == first) return nullptr;
+        uint32_t k = *(it - 1);
+        while (k != NONE && entries[k].scopeEnd < when) k = entries[k].shadowed;
+        return k == NONE ? nullptr : &entries[k].binding;
+    }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr uint32_t OPEN = UINT32_MAX;
+    struct Entry {
+        Binding binding;
+        SymbolId name;
+        uint32_t shadowed;                     // entrada escondida por esta (ou NONE)
+        uint32_t order;                        // instante da declaração
+        uint32_t scopeEnd;                     // instante em que o escopo fechou (ou OPEN)
+    };
+    std::vector<uint32_t> visible;             // id do nome -> entrada visível
+    std::vector<Entry> entries;                // todas as declarações, em ordem
+    std::vector<uint32_t> open;                // entradas dos escopos abertos
+    std::vector<uint32_t> scopes{0};           // primeira posição de `open` de cada escopo
+    uint32_t clock = 0;
+    std::vector<uint32_t> byNameStart;         // índice de indexHistory() (CSR por nome)
+    std::vector<uint32_t> byName;
+};
+
 // Resultado da análise semântica
 struct SemanticResult {
-    std::unordered_map<std::string, TypeKind> symbols;
+    SymbolTable symbols;
     std::vector<SemanticError> errors;
 };
 
@@ -41,24 +144,12 @@ static std::string typeToString(TypeKind t) {
 
 // Mapeia token de tipo de declaração para TypeKind
 static TypeKind mapDeclType(const Token& tok) {
-    const std::string& t = tok.texto;
-    if (t == "int") return TypeKind::INT;
-    if (t == "float" || t == "double") return TypeKind::REAL;
-    if (t == "string") return TypeKind::STRING;
-    if (t == "bool" || t == "boolean") return TypeKind::BOOL;
-    return TypeKind::UNKNOWN;
-}
-
-// Retorna o tipo de um literal baseado no token
-static TypeKind literalType(const Token& tok) {
     switch (tok.tipo) {
-        case TokenType::NUM_INT:  return TypeKind::INT;
-        case TokenType::NUM_REAL: return TypeKind::REAL;
-        case TokenType::STRING:   return TypeKind::STRING;
-        case TokenType::KEYWORD:
-            if (tok.texto == "true" || tok.texto == "false") return TypeKind::BOOL;
-            return TypeKind::UNKNOWN;
-        default:                  return TypeKind::UNKNOWN;
+        case TokenType::KW_INT:     return TypeKind::INT;
+        case TokenType::KW_FLOAT:   return TypeKind::REAL;
+        case TokenType::KW_STRING:  return TypeKind::STRING;
+        case TokenType::KW_BOOLEAN: return TypeKind::BOOL;
+        default:                    return TypeKind::UNKNOWN;
     }
 }
 
@@ -67,155 +158,235 @@ static void report(std::vector<SemanticError>& errs, const std::string& msg, con
     errs.push_back({msg, tok.linha, tok.coluna});
 }
 
-// Retorna o tipo resultante e verifica tipos em expressões
-static TypeKind evalExpr(const std::shared_ptr<ASTNode>& node, SemanticResult& ctx) {
-    if (!node) return TypeKind::UNKNOWN;            // Evitar ponteiro nulo
-
-    switch (node->kind) {                           // Tipo de nó
+// Tipo de uma folha de expressão (literal ou identificador); um
+// identificador é resolvido para o seu (escopo, slot) pela declaração que
+// `lookup(id)` devolve (nullptr se não há)
+template <typename Lookup>
+static TypeKind leafType(AstPool& ast, NodeId node, const Lookup& lookup, std::vector<SemanticError>& errs) {
+    switch (ast.kind(node)) {                           // Tipo de nó
         //caso literal
-        case NodeKind::Literal:
-            return literalType(node->token);
+        case NodeKind::Literal: {
+            TypeKind t = ast.literal(node).type;   // decodificado no lowering
+            ast.setType(node, t);
+            return t;
+        }
 
         // caso identificador
         case NodeKind::Identifier: {
-            auto it = ctx.symbols.find(node->value);
-            if (it == ctx.symbols.end()) {
-                report(ctx.errors, "variavel '" + node->value + "' usada sem declarar", node->token);
+            const Binding* b = lookup(ast.token(node).simbolo);
+            if (!b) {
+                report(errs, "variavel '" + std::string(ast.value(node)) + "' usada sem declarar", ast.token(node));
                 return TypeKind::UNKNOWN;       // variável não declarada
             }
-            return it->second;  // retornar tipo declarado
+            ast.setSlot(node, b->depth, b->slot, b->type);
+            return b->type;     // retornar tipo declarado
         }
 
-        // caso binário
-        case NodeKind::Binary: {
-            TypeKind lt = evalExpr(node->children[0], ctx);     // tipo do operando esquerdo
-            TypeKind rt = evalExpr(node->children[1], ctx);     // tipo do operando direito
-            const std::string& op = node->value;
-
-            auto isNumeric = [](TypeKind t) {                       // verifica se é tipo numérico
-                return t == TypeKind::INT || t == TypeKind::REAL;   //retorna true se for int ou real
-            };
-
-            //se for operador aritmético
-            if (op == "+" || op == "-" || op == "*" || op == "/" || op == "%") {
-                //verifica se ambos os operandos são numéricos
-                if (!isNumeric(lt) || !isNumeric(rt)) {
-                    report(ctx.errors, "operador '" + op + "' exige operandos numericos", node->token);
-                    return TypeKind::UNKNOWN;   // tipo desconhecido
-                }
-                //verifica se o operador % tem operandos int
-                if (op == "%" && (lt != TypeKind::INT || rt != TypeKind::INT)) {
-                    report(ctx.errors, "operador '%' exige operandos int", node->token);
-                }
-                //retorna o tipo resultante
-                return (lt == TypeKind::REAL || rt == TypeKind::REAL) ? TypeKind::REAL : TypeKind::INT;
+        default:                        // outros tipos de nó
+            return TypeKind::UNKNOWN;
+    }
+}
+
+// Tipo de um nó binário a partir dos tipos dos operandos
+static TypeKind binaryType(const AstPool& ast, NodeId node, TypeKind lt, TypeKind rt, std::vector<SemanticError>& errs) {
+    BinaryOp op = ast.op(node);                         // operador do lowering
+
+    auto isNumeric = [](TypeKind t) {                       // verifica se é tipo numérico
+        return t == TypeKind::INT || t == TypeKind::REAL;   //retorna true se for int ou real
+    };
+
+    switch (op) {
+        //se for operador aritmético
+        case BinaryOp::Add: case BinaryOp::Sub: case BinaryOp::Mul:
+        case BinaryOp::Div: case BinaryOp::Mod:
+            //verifica se ambos os operandos são numéricos
+            if (!isNumeric(lt) || !isNumeric(rt)) {
+                report(errs, std::string("operador '") + binaryOpSymbol(op) + "' exige operandos numericos", ast.token(node));
+                return TypeKind::UNKNOWN;   // tipo desconhecido
+            }
+            //verifica se o operador % tem operandos int
+            if (op == BinaryOp::Mod && (lt != TypeKind::INT || rt != TypeKind::INT)) {
+                report(errs, "operador '%' exige operandos int", ast.token(node));
             }
+            //retorna o tipo resultante
+            return (lt == TypeKind::REAL || rt == TypeKind::REAL) ? TypeKind::REAL : TypeKind::INT;
 
-            //se for operador de comparação
-            if (op == "==" || op == "!=" || op == "<" || op == ">" || op == "<=" || op == ">=") {
-                //verifica se ambos os operandos são numéricos
-                if (!isNumeric(lt) || !isNumeric(rt)) {
-                    report(ctx.errors, "comparacao '" + op + "' exige operandos numericos", node->token);
-                }
-                return TypeKind::BOOL;  // tipo booleano
+        //se for operador de comparação
+        case BinaryOp::Eq: case BinaryOp::Ne: case BinaryOp::Lt:
+        case BinaryOp::Le: case BinaryOp::Gt: case BinaryOp::Ge:
+            //verifica se ambos os operandos são numéricos
+            if (!isNumeric(lt) || !isNumeric(rt)) {
+                report(errs, std::string("comparacao '") + binaryOpSymbol(op) + "' exige operandos numericos", ast.token(node));
             }
+            return TypeKind::BOOL;  // tipo booleano
 
-            //se for operador lógico
-            if (op == "&&" || op == "||") {
-                //verifica se ambos os operandos são booleanos
-                if (lt != TypeKind::BOOL || rt != TypeKind::BOOL) {
-                    report(ctx.errors, "operador logico '" + op + "' exige operandos bool", node->token);
-                }
-                return TypeKind::BOOL;  // tipo booleano
+        //se for operador lógico
+        case BinaryOp::And: case BinaryOp::Or:
+            //verifica se ambos os operandos são booleanos
+            if (lt != TypeKind::BOOL || rt != TypeKind::BOOL) {
+                report(errs, std::string("operador logico '") + binaryOpSymbol(op) + "' exige operandos bool", ast.token(node));
             }
+            return TypeKind::BOOL;  // tipo booleano
 
+        default:
             return TypeKind::UNKNOWN;   // tipo desconhecido
+    }
+}
+
+// Declaração: acusa redeclaração no mesmo escopo e registra a variável no
+// próximo slot (antes do inicializador); em escopo interno ela esconde a
+// de fora
+static Binding declareVariable(const Token& typeTok, const Token& idTok, SemanticResult& ctx) {
+    TypeKind declType = mapDeclType(typeTok);           // tipo declarado
+    if (ctx.symbols.declaredHere(idTok.simbolo)) {      // verifica redeclaração
+        report(ctx.errors, "variavel '" + std::string(idTok.texto) + "' redeclarada", typeTok);
+    }
+    return ctx.symbols.declare(idTok.simbolo, declType);   // adiciona ao escopo
+}
+
+// Abre o escopo de um bloco (a profundidade cabe em 16 bits no nó)
+static void enterBlock(const Token& lbrace, SemanticResult& ctx) {
+    if (ctx.symbols.depth() == UINT16_MAX) report(ctx.errors, "blocos aninhados demais", lbrace);
+    ctx.symbols.enterScope();
+}
+
+// Inicialização compatível com o tipo declarado (int → float permitido)
+static void checkInit(TypeKind declType, TypeKind initType, const Token& typeTok, std::vector<SemanticError>& errs) {
+    if (declType != TypeKind::UNKNOWN && initType != TypeKind::UNKNOWN && declType != initType) {
+        bool numericCompat = (declType == TypeKind::REAL && initType == TypeKind::INT);
+        //verifica compatibilidade numérica
+        if (!numericCompat) {
+            report(errs, "tipos incompativeis na inicializacao: declarado " +
+                typeToString(declType) + ", obtido " + typeToString(initType), typeTok);
         }
+    }
+}
 
-        default:                        // outros tipos de nó
-            return TypeKind::UNKNOWN;
+// Alvo de atribuição: a declaração visível, ou tipo UNKNOWN se a variável
+// não existe
+static Binding assignTarget(const Token& idTok, SemanticResult& ctx) {
+    const Binding* declared = ctx.symbols.find(idTok.simbolo);    // procura nos escopos abertos
+    if (!declared) {
+        report(ctx.errors, "variavel '" + std::string(idTok.texto) + "' usada sem declarar", idTok);
+        return {0, 0, TypeKind::UNKNOWN};
+    }
+    return *declared;
+}
+
+// Atribuição compatível com o tipo do alvo
+static void checkAssign(TypeKind target, TypeKind exprType, const Token& tok, std::vector<SemanticError>& errs) {
+    if (target != TypeKind::UNKNOWN && exprType != TypeKind::UNKNOWN && target != exprType) {
+        bool numericCompat = (target == TypeKind::REAL && exprType == TypeKind::INT);
+        //verifica compatibilidade numérica
+        if (!numericCompat) {
+            report(errs, "tipos incompativeis na atribuicao: esperado " +
+                typeToString(target) + ", obtido " + typeToString(exprType), tok);
+        }
     }
 }
 
-// Função recursiva para checar a AST
-static void checkNode(const std::shared_ptr<ASTNode>& node, SemanticResult& ctx) {
-    if (!node) return;                      // Evitar ponteiro nulo
+// Condição do if deve ser booleana
+static void checkCondition(TypeKind condType, const Token& condTok, std::vector<SemanticError>& errs) {
+    if (condType != TypeKind::BOOL && condType != TypeKind::UNKNOWN) {
+        report(errs, "condicao do if deve ser bool", condTok);
+    }
+}
+
+// Retorna o tipo resultante e verifica tipos em expressões. Percorre em
+// pós-ordem com pilhas explícitas, então expressões muito profundas não
+// estouram a pilha de chamadas; os erros saem na mesma ordem da recursão.
+template <typename Lookup>
+static TypeKind evalExpr(AstPool& ast, NodeId root, const Lookup& lookup, std::vector<SemanticError>& errs) {
+    if (root == NO_NODE) return TypeKind::UNKNOWN;            // Evitar ponteiro nulo
+    if (ast.kind(root) != NodeKind::Binary) return leafType(ast, root, lookup, errs);  // caso comum
 
-    switch (node->kind) {                   // Tipo de nó
-        //casos compostos
+    thread_local std::vector<std::pair<NodeId, bool>> work;  // (nó, filhos já empilhados)
+    thread_local std::vector<TypeKind> types;                // tipos dos operandos prontos
+    size_t workBase = work.size();
+    size_t typeBase = types.size();
+    work.push_back({root, false});
+    while (work.size() > workBase) {
+        auto [node, expanded] = work.back();
+        work.pop_back();
+        if (ast.kind(node) != NodeKind::Binary) {
+            types.push_back(leafType(ast, node, lookup, errs));
+        } else if (!expanded) {
+            work.push_back({node, true});
+            work.push_back({ast.child(node, 1), false});
+            work.push_back({ast.child(node, 0), false});
+        } else {
+            TypeKind rt = types.back();
+            types.pop_back();
+            types.back() = binaryType(ast, node, types.back(), rt, errs);
+            ast.setType(node, types.back());
+        }
+    }
+    TypeKind t = types.back();
+    types.resize(typeBase);
+    return t;
+}
+
+// Nomes resolvidos pelos escopos abertos agora (checagem sequencial)
+struct VisibleNow {
+    const SymbolTable& symbols;
+    const Binding* operator()(SymbolId id) const { return symbols.find(id); }
+};
+
+static TypeKind evalExpr(AstPool& ast, NodeId root, SemanticResult& ctx) {
+    return evalExpr(ast, root, VisibleNow{ctx.symbols}, ctx.errors);
+}
+
+// Função recursiva para checar a AST (e resolver os nomes nos nós)
+static void checkNode(AstPool& ast, NodeId node, SemanticResult& ctx) {
+    if (node == NO_NODE) return;                      // Evitar ponteiro nulo
+
+    switch (ast.kind(node)) {                   // Tipo de nó
+        //caso programa (o escopo de fora já está aberto)
         case NodeKind::Program:
-        //caso bloco
+            for (size_t i = 0; i < ast.childCount(node); ++i) checkNode(ast, ast.child(node, i), ctx);// verifica cada filho 
+            ast.setFrameSize(node, ctx.symbols.scopeSlots());
+            break;
+
+        //caso bloco: escopo próprio
         case NodeKind::Block:
-            for (auto& c : node->children) checkNode(c, ctx);// verifica cada filho 
+            enterBlock(ast.token(node), ctx);
+            for (size_t i = 0; i < ast.childCount(node); ++i) checkNode(ast, ast.child(node, i), ctx);
+            ast.setFrameSize(node, ctx.symbols.exitScope());
             break;
 
         // caso declaração
         case NodeKind::Decl: {
-            TypeKind declType = mapDeclType(node->token);       // tipo declarado
-            const std::string& name = node->value;              // nome da variável
-            // verifica redeclaração
-            if (ctx.symbols.count(name)) {  
-                report(ctx.errors, "variavel '" + name + "' redeclarada", node->token);
-            }
-            ctx.symbols[name] = declType;                       // adiciona ao contexto
+            Binding var = declareVariable(ast.token(node), ast.token(ast.child(node, 0)), ctx);
+            ast.setSlot(ast.child(node, 0), var.depth, var.slot, var.type);
 
             // verifica inicialização
-            if (node->children.size() > 1) {
-                TypeKind initType = evalExpr(node->children[1], ctx);
-                // verifica compatibilidade de tipos
-                if (declType != TypeKind::UNKNOWN && initType != TypeKind::UNKNOWN && declType != initType) {
-                    bool numericCompat = (declType == TypeKind::REAL && initType == TypeKind::INT);
-                    //verifica compatibilidade numérica
-                    if (!numericCompat) {
-                        report(ctx.errors, "tipos incompativeis na inicializacao: declarado " +
-                            typeToString(declType) + ", obtido " + typeToString(initType), node->token);
-                    }
-                }
+            if (ast.childCount(node) > 1) {
+                TypeKind initType = evalExpr(ast, ast.child(node, 1), ctx);
+                checkInit(var.type, initType, ast.token(node), ctx.errors);
             }
             break;
         }
 
         // caso atribuição
         case NodeKind::Assign: {
-            const auto& idNode = node->children[0];             // nó do identificador
-            const std::string& name = idNode->value;
-            auto it = ctx.symbols.find(name);                   // procura na tabela de símbolos
-            TypeKind target = TypeKind::UNKNOWN;                // tipo alvo
-            // verifica se a variável foi declarada
-            if (it == ctx.symbols.end()) {
-                report(ctx.errors, "variavel '" + name + "' usada sem declarar", idNode->token);
-            }
-            // se declarada, obtém o tipo 
-            else {
-                target = it->second;
-            }
+            Binding target = assignTarget(ast.token(ast.child(node, 0)), ctx);     // variável alvo
+            ast.setSlot(ast.child(node, 0), target.depth, target.slot, target.type);
             // avalia o tipo da expressão atribuída
-            TypeKind exprType = evalExpr(node->children[1], ctx);
-            // verifica compatibilidade de tipos
-            if (target != TypeKind::UNKNOWN && exprType != TypeKind::UNKNOWN && target != exprType) {
-                bool numericCompat = (target == TypeKind::REAL && exprType == TypeKind::INT);
-                //verifica compatibilidade numérica
-                if (!numericCompat) {
-                    report(ctx.errors, "tipos incompativeis na atribuicao: esperado " +
-                        typeToString(target) + ", obtido " + typeToString(exprType), node->token);
-                }
-            }
+            TypeKind exprType = evalExpr(ast, ast.child(node, 1), ctx);
+            checkAssign(target.type, exprType, ast.token(node), ctx.errors);
             break;
         }
 
         // caso if
         case NodeKind::If: {
             // verifica tipo da condição
-            if (!node->children.empty()) {
-                TypeKind condType = evalExpr(node->children[0], ctx);
-                // verifica se é booleano
-                if (condType != TypeKind::BOOL && condType != TypeKind::UNKNOWN) {
-                    report(ctx.errors, "condicao do if deve ser bool", node->children[0]->token);
-                }
+            if (ast.childCount(node) > 0) {
+                TypeKind condType = evalExpr(ast, ast.child(node, 0), ctx);
+                checkCondition(condType, ast.token(ast.child(node, 0)), ctx.errors);
             }
             // verifica os ramos then e else
-            for (size_t i = 1; i < node->children.size(); ++i) {
-                checkNode(node->children[i], ctx);
+            for (size_t i = 1; i < ast.childCount(node); ++i) {
+                checkNode(ast, ast.child(node, i), ctx);
             }
             break;
         }
@@ -225,9 +396,98 @@ static void checkNode(const std::shared_ptr<ASTNode>& node, SemanticResult& ctx)
     }
 }
 
-// Função principal para checagem semântica do programa
-inline SemanticResult checkProgram(const std::shared_ptr<ASTNode>& root) {
+// depende das regras de tipo acima
+#include "specialize.cpp"
+
+// Função principal para checagem semântica do programa. Além de acusar
+// erros, anota cada Identifier com o (escopo, slot) da variável, cada
+// Program/Block com o tamanho do frame e cada expressão com o seu tipo; um
+// programa sem erros sai especializado (specializeProgram) para o executor.
+inline SemanticResult checkProgram(AstPool& ast) {
     SemanticResult res;
-    checkNode(root, res);
+    checkNode(ast, ast.root, res);
+    if (res.errors.empty()) specializeProgram(ast);
     return res;
 }
+
+// depende de checkNode e das regras acima
+#include "parallel.cpp"
+
+// Front end fundido: os ganchos do parser aplicam as mesmas regras de
+// checkNode à medida que os nós ficam prontos. O parser cria os nós de uma
+// expressão em pós-ordem, então os tipos dos operandos ficam numa pilha e
+// os erros saem na mesma ordem da passada separada.
+class FusedChecker : public ParseHooks {
+public:
+    explicit FusedChecker(SemanticResult& r) : res(r) {}
+
+    void declared(const Token& typeTok, const Token& idTok) override {
+        decl = declareVariable(typeTok, idTok, res);
+    }
+    void declEnd(AstPool& ast, NodeId node) override {
+        ast.setSlot(ast.child(node, 0), decl.depth, decl.slot, decl.type);
+        if (ast.childCount(node) > 1) checkInit(decl.type, pop(), ast.token(node), res.errors);
+    }
+    void assignTarget(const Token& idTok) override {
+        target = ::assignTarget(idTok, res);
+    }
+    void assignEnd(AstPool& ast, NodeId assign) override {
+        ast.setSlot(ast.child(assign, 0), target.depth, target.slot, target.type);
+        checkAssign(target.type, pop(), ast.token(assign), res.errors);
+    }
+    void condition(const AstPool& ast, NodeId cond) override {
+        checkCondition(pop(), ast.token(cond), res.errors);
+    }
+    void leaf(AstPool& ast, NodeId node) override {
+        types.push_back(leafType(ast, node, VisibleNow{res.symbols}, res.errors));
+    }
+    void binary(AstPool& ast, NodeId node) override {
+        TypeKind rt = pop();
+        types.back() = binaryType(ast, node, types.back(), rt, res.errors);
+        ast.setType(node, types.back());
+    }
+    void blockBegin(const Token& lbrace) override {
+        enterBlock(lbrace, res);
+    }
+    void blockEnd(AstPool& ast, NodeId block) override {
+        ast.setFrameSize(block, res.symbols.exitScope());
+    }
+
+private:
+    TypeKind pop() {
+        TypeKind t = types.back();
+        types.pop_back();
+        return t;
+    }
+
+    SemanticResult& res;
+    std::vector<TypeKind> types;        // tipos das subexpressões prontas
+    Binding decl{};                     // declaração em curso (não aninham)
+    Binding target{};                   // alvo da atribuição em curso
+};
+
+// AST já baixada e resultado semântico
+struct FrontEndResult {
+    AstPool ast;
+    SemanticResult sem;
+};
+
+// Lexer, parser e checagem numa passada só sobre o texto: o mesmo resultado
+// de parseSource() + checkProgram(), sem percorrer a AST de novo. Arquivos
+// que vão pelo parse paralelo são checados depois, pelo checador paralelo.
+inline FrontEndResult analyzeSource(std::string_view text, Interner& symbols) {
+    FrontEndResult out;
+    if (useParallelParse(text)) {
+        out.ast = parseSource(text, symbols);
+        out.sem = checkProgramParallel(out.ast, defaultThreadPool());
+        return out;
+    }
+    Lexer lexer(text, &symbols);
+    Parser parser(lexer);
+    FusedChecker checker(out.sem);
+    parser.setHooks(&checker);
+    out.ast = parser.parse();
+    out.ast.setFrameSize(out.ast.root, out.sem.symbols.scopeSlots());   // escopo do programa
+    if (out.sem.errors.empty()) specializeProgram(out.ast);
+    return out;
+}
@@ -0,0 +1,78 @@
+// specialize.cpp
+// Compiladores - Especialização da AST pelos tipos da semântica: cada
+// Binary ganha a operação do tipo dos operandos (ExecOp) e cada int usado
+// onde se espera real (operando misto, inicialização ou atribuição a
+// float) ganha um nó Promote. Só roda em programas sem erros, depois da
+// checagem, e o executor confia no resultado sem testar tipos.
+#include <vector>
+
+// Operação de `op` sobre operandos já do mesmo tipo `t`
+static ExecOp execOpFor(BinaryOp op, TypeKind t) {
+    bool real = (t == TypeKind::REAL);
+    switch (op) {
+        case BinaryOp::Add: return real ? ExecOp::AddReal : ExecOp::AddInt;
+        case BinaryOp::Sub: return real ? ExecOp::SubReal : ExecOp::SubInt;
+        case BinaryOp::Mul: return real ? ExecOp::MulReal : ExecOp::MulInt;
+        case BinaryOp::Div: return real ? ExecOp::DivReal : ExecOp::DivInt;
+        case BinaryOp::Mod: return ExecOp::ModInt;
+        case BinaryOp::Eq:  return real ? ExecOp::EqReal : ExecOp::EqInt;
+        case BinaryOp::Ne:  return real ? ExecOp::NeReal : ExecOp::NeInt;
+        case BinaryOp::Lt:  return real ? ExecOp::LtReal : ExecOp::LtInt;
+        case BinaryOp::Le:  return real ? ExecOp::LeReal : ExecOp::LeInt;
+        case BinaryOp::Gt:  return real ? ExecOp::GtReal : ExecOp::GtInt;
+        case BinaryOp::Ge:  return real ? ExecOp::GeReal : ExecOp::GeInt;
+        case BinaryOp::And: return ExecOp::And;
+        case BinaryOp::Or:  return ExecOp::Or;
+        default:            return ExecOp::None;
+    }
+}
+
+// Troca o filho k (int) de `parent` por Promote(filho)
+static void promoteChild(AstPool& ast, NodeId parent, size_t k) {
+    NodeId kid = ast.child(parent, k);
+    NodeId promote = ast.add(NodeKind::Promote, ast.node(kid).token, &kid, 1);
+    ast.setType(promote, TypeKind::REAL);
+    ast.setChild(parent, k, promote);
+}
+
+// Promove o filho k se ele é int e o destino é real
+static void promoteIfNeeded(AstPool& ast, NodeId parent, size_t k, TypeKind expected) {
+    if (expected == TypeKind::REAL && ast.type(ast.child(parent, k)) == TypeKind::INT) promoteChild(ast, parent, k);
+}
+
+// Especializa todos os nós alcançáveis da raiz (pilha explícita; a ordem
+// não importa, pois cada nó só depende dos tipos anotados nos filhos)
+inline void specializeProgram(AstPool& ast) {
+    if (ast.root == NO_NODE) return;
+    std::vector<NodeId> work = {ast.root};
+    while (!work.empty()) {
+        NodeId node = work.back();
+        work.pop_back();
+        for (size_t i = 0; i < ast.childCount(node); ++i) work.push_back(ast.child(node, i));
+
+        switch (ast.kind(node)) {
+            case NodeKind::Binary: {
+                TypeKind lt = ast.type(ast.child(node, 0));
+                TypeKind rt = ast.type(ast.child(node, 1));
+                bool mixed = (lt == TypeKind::REAL) != (rt == TypeKind::REAL);   // int com real
+                if (mixed) {
+                    promoteIfNeeded(ast, node, 0, TypeKind::REAL);
+                    promoteIfNeeded(ast, node, 1, TypeKind::REAL);
+                }
+                ast.setExec(node, execOpFor(ast.op(node), mixed ? TypeKind::REAL : lt));
+                break;
+            }
+
+            case NodeKind::Decl:
+                if (ast.childCount(node) > 1) promoteIfNeeded(ast, node, 1, ast.type(ast.child(node, 0)));
+                break;
+
+            case NodeKind::Assign:
+                promoteIfNeeded(ast, node, 1, ast.type(ast.child(node, 0)));
+                break;
+
+            default:
+                break;
+        }
+    }
+}
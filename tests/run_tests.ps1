@@ -18,11 +18,31 @@ $tests = @(
     @{ Name="ast_err_sem_undeclarado"; Mode="--ast"; Input="tests\err_semantico_undeclarado.txt"; Expected="tests\ast_out\err_semantico_undeclarado.ast.out" },
     @{ Name="ast_err_sem_tipo"; Mode="--ast"; Input="tests\err_semantico_tipo.txt"; Expected="tests\ast_out\err_semantico_tipo.ast.out" },
     @{ Name="ast_err_sem_if"; Mode="--ast"; Input="tests\err_semantico_if.txt"; Expected="tests\ast_out\err_semantico_if.ast.out" },
+    @{ Name="ast_err_sintatico_multi"; Mode="--ast"; Input="tests\err_sintatico_multi.txt"; Expected="tests\ast_out\err_sintatico_multi.ast.out" },
+    @{ Name="ast_ok_escopos"; Mode="--ast"; Input="tests\ok_escopos.txt"; Expected="tests\ast_out\ok_escopos.ast.out" },
+    @{ Name="ast_err_sem_escopo"; Mode="--ast"; Input="tests\err_semantico_escopo.txt"; Expected="tests\ast_out\err_semantico_escopo.ast.out" },
+    @{ Name="ast_cse_ok_cse"; Mode="--ast"; Args=@("--passes","cse"); Input="tests\ok_cse.txt"; Expected="tests\ast_out\ok_cse.cse.ast.out" },
+    @{ Name="ast_imagem_cse_ok_cse"; Mode="--ast"; Args=@("--passes","cse"); Input="tests\ok_cse.txt"; Image=$true; Expected="tests\ast_out\ok_cse.cse.ast.out" },
+    @{ Name="ast_O1_ok_constantes"; Mode="--ast"; Args=@("-O1"); Input="tests\ok_constantes.txt"; Expected="tests\ast_out\ok_constantes.O1.ast.out" },
 
     @{ Name="run_ok_basico"; Mode="--run"; Input="tests\ok_basico.txt"; Expected="tests\run_out\ok_basico.run.out" },
     @{ Name="run_err_sem_undeclarado"; Mode="--run"; Input="tests\err_semantico_undeclarado.txt"; Expected="tests\run_out\err_semantico_undeclarado.run.out" },
     @{ Name="run_err_sem_tipo"; Mode="--run"; Input="tests\err_semantico_tipo.txt"; Expected="tests\run_out\err_semantico_tipo.run.out" },
-    @{ Name="run_err_sem_if"; Mode="--run"; Input="tests\err_semantico_if.txt"; Expected="tests\run_out\err_semantico_if.run.out" }
+    @{ Name="run_err_sem_if"; Mode="--run"; Input="tests\err_semantico_if.txt"; Expected="tests\run_out\err_semantico_if.run.out" },
+    @{ Name="run_ok_escopos"; Mode="--run"; Input="tests\ok_escopos.txt"; Expected="tests\run_out\ok_escopos.run.out" },
+    @{ Name="run_err_sem_escopo"; Mode="--run"; Input="tests\err_semantico_escopo.txt"; Expected="tests\run_out\err_semantico_escopo.run.out" },
+    @{ Name="run_ok_constantes"; Mode="--run"; Input="tests\ok_constantes.txt"; Expected="tests\run_out\ok_constantes.run.out" },
+    @{ Name="run_cse_ok_cse"; Mode="--run"; Args=@("--passes","cse"); Input="tests\ok_cse.txt"; Expected="tests\run_out\ok_cse.cse.run.out" },
+    @{ Name="run_cache_ok_escopos"; Mode="--run"; Input="tests\ok_escopos.txt"; Cache=$true; Expected="tests\run_out\ok_escopos.run.out" },
+    @{ Name="run_imagem_ok_constantes"; Mode="--run"; Input="tests\ok_constantes.txt"; Image=$true; Expected="tests\run_out\ok_constantes.run.out" },
+
+    @{ Name="ir_ok_basico"; Mode="--ir"; Input="tests\ok_basico.txt"; Expected="tests\ir_out\ok_basico.ir.out" },
+    @{ Name="ir_cse_ok_cse"; Mode="--ir"; Args=@("--passes","cse"); Input="tests\ok_cse.txt"; Expected="tests\ir_out\ok_cse.cse.ir.out" },
+
+    @{ Name="edit_ok_basico"; Mode="--edit"; Input="tests\ok_basico.txt"; Script="tests\ok_basico.edits"; Expected="tests\edit_out\ok_basico.edit.out" },
+
+    @{ Name="check_ok_basico"; Mode="--check"; Input="tests\ok_basico.txt"; Expected="tests\check_out\ok_basico.check.out" },
+    @{ Name="check_err_sintatico_multi"; Mode="--check"; Input="tests\err_sintatico_multi.txt"; Expected="tests\check_out\err_sintatico_multi.check.out" }
 )
 
 function Normalize([string]$text) {
@@ -40,7 +60,49 @@ foreach ($t in $tests) {
 
     $tmp = New-TemporaryFile
 
-    $actualLinesRaw = & $exePath $t.Mode $t.Input 2>&1
+    # Args: opções extras antes do modo (ex.: -O1)
+    $extraArgs = @()
+    if ($t.Args) { $extraArgs = $t.Args }
+
+    # Image: grava a entrada com --emit-ast-bin e roda o modo sobre a imagem
+    $inputPath = $t.Input
+    $imagePath = $null
+    if ($t.Image) {
+        $imagePath = Join-Path ([System.IO.Path]::GetTempPath()) "$($t.Name).astb"
+        & $exePath @extraArgs --emit-ast-bin $imagePath $t.Input 2>&1 | Out-Null
+        $inputPath = $imagePath
+    }
+
+    # Script: roteiro de edições depois da entrada (--edit)
+    $modeArgs = @($t.Mode, $inputPath)
+    if ($t.Script) { $modeArgs += $t.Script }
+
+    if ($t.Cache) {
+        # Cache: roda com --cache-dir uma vez (grava a entrada), outra (lê a
+        # entrada) e outra depois de corromper a entrada (falta, regrava);
+        # as três saídas têm de ser iguais
+        $cacheDir = Join-Path ([System.IO.Path]::GetTempPath()) "$($t.Name).cache"
+        Remove-Item -Recurse -Force $cacheDir -ErrorAction SilentlyContinue
+        $runs = @()
+        $runs += ,(& $exePath --cache-dir $cacheDir @extraArgs @modeArgs 2>&1)
+        $entries = @(Get-ChildItem $cacheDir -Filter *.astb -ErrorAction SilentlyContinue)
+        $runs += ,(& $exePath --cache-dir $cacheDir @extraArgs @modeArgs 2>&1)
+        foreach ($e in $entries) {
+            $bytes = [System.IO.File]::ReadAllBytes($e.FullName)
+            $bytes[[int]($bytes.Length / 2)] = $bytes[[int]($bytes.Length / 2)] -bxor 0xFF
+            [System.IO.File]::WriteAllBytes($e.FullName, $bytes)
+        }
+        $runs += ,(& $exePath --cache-dir $cacheDir @extraArgs @modeArgs 2>&1)
+
+        $actualLinesRaw = $runs[0]
+        if ($entries.Count -eq 0) { $actualLinesRaw = @("[nenhuma entrada gravada no cache]") + $runs[0] }
+        foreach ($r in $runs[1..2]) {
+            if (($r -join "`n") -ne ($runs[0] -join "`n")) { $actualLinesRaw = @("[saida diferente com o cache]") + $r }
+        }
+        Remove-Item -Recurse -Force $cacheDir -ErrorAction SilentlyContinue
+    } else {
+        $actualLinesRaw = & $exePath @extraArgs @modeArgs 2>&1
+    }
     $exitCode = $LASTEXITCODE
     Set-Content -Path $tmp -Value ($actualLinesRaw -join "`r`n")
 
@@ -71,6 +133,7 @@ foreach ($t in $tests) {
     }
 
     Remove-Item $tmp -ErrorAction SilentlyContinue
+    if ($imagePath) { Remove-Item $imagePath -ErrorAction SilentlyContinue }
 }
 
 Write-Host "`nResumo:"
@@ -0,0 +1,123 @@
+// thread_pool.cpp
+// Compiladores - Pool de threads usado pelas fases paralelas
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool fixo de threads com fila de tarefas. parallelFor distribui índices
+// por um contador atômico; a thread chamadora também trabalha.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads) {
+        for (size_t t = 1; t < threads; ++t) {             // a chamadora é a outra thread
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto& w : workers) w.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // número de threads que executam trabalho (incluindo a chamadora)
+    size_t size() const { return workers.size() + 1; }
+
+    // Executa fn(i) para todo i em [0, n) e espera terminar. Uma exceção
+    // lançada por fn é relançada na thread chamadora.
+    template <typename Fn>
+    void parallelFor(size_t n, Fn&& fn) {
+        if (n == 0) return;
+        if (n == 1 || workers.empty()) {
+            for (size_t i = 0; i < n; ++i) fn(i);
+            return;
+        }
+
+        std::atomic<size_t> next{0};
+        std::exception_ptr failure;
+        std::mutex failureMutex;
+        auto drain = [&] {
+            size_t i;
+            while ((i = next.fetch_add(1)) < n) {
+                try {
+                    fn(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(failureMutex);
+                    if (!failure) failure = std::current_exception();
+                }
+            }
+        };
+
+        size_t helpers = std::min(workers.size(), n - 1);
+        size_t pending = helpers;
+        std::mutex doneMutex;
+        std::condition_variable doneCv;
+        {
+            std::lock_guard<std::mutex> lock(m);
+            for (size_t h = 0; h < helpers; ++h) {
+                jobs.emplace_back([&] {
+                    drain();
+                    std::lock_guard<std::mutex> doneLock(doneMutex);
+                    if (--pending == 0) doneCv.notify_one();
+                });
+            }
+        }
+        cv.notify_all();
+
+        drain();
+        std::unique_lock<std::mutex> lock(doneMutex);
+        doneCv.wait(lock, [&] { return pending == 0; });
+        if (failure) std::rethrow_exception(failure);
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex m;
+    std::condition_variable cv;
+    bool stopping = false;
+
+    void workerLoop() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (stopping && jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+};
+
+// Número de threads das fases paralelas: MICROCOMPILADOR_THREADS ou o
+// número de núcleos da máquina
+inline size_t defaultThreadCount() {
+    if (const char* env = std::getenv("MICROCOMPILADOR_THREADS")) {
+        long n = std::strtol(env, nullptr, 10);
+        if (n > 0) return static_cast<size_t>(n);
+    }
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw ? hw : 1;
+}
+
+// Pool compartilhado, criado no primeiro uso
+inline ThreadPool& defaultThreadPool() {
+    static ThreadPool pool(defaultThreadCount());
+    return pool;
+}